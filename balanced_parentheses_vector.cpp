@@ -2,6 +2,9 @@
 // Created by Dim Dew on 2020-07-23.
 //
 
+#include <algorithm>
+#include <limits>
+
 #include "balanced_parentheses_vector.h"
 
 namespace succinct {
@@ -71,9 +74,242 @@ namespace succinct {
 
     const static excess_tables tables;
 
+#ifdef PDT_HW_AVX2
+    // Vector kernels: the excess after every bit of the word is computed at
+    // once (one byte per bit, |excess| <= 64 fits in int8) with a log-step
+    // prefix sum, and the answer is the first byte equal to the target.
+    namespace {
+        // 0xFF in byte i where bit i of `bits` is set
+        inline __m256i expand_bits_256(uint32_t bits) {
+            const __m256i select_byte = _mm256_setr_epi8(
+                    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                    2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+            const __m256i bit_in_byte = _mm256_set1_epi64x(0x8040201008040201LL);
+            __m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32(int(bits)), select_byte);
+            return _mm256_cmpeq_epi8(_mm256_and_si256(v, bit_in_byte), bit_in_byte);
+        }
+
+        // +1 for "(", -1 for ")"
+        inline __m256i steps_256(uint32_t bits) {
+            return _mm256_blendv_epi8(_mm256_set1_epi8(-1), _mm256_set1_epi8(1), expand_bits_256(bits));
+        }
+
+        // byte i: `carry` + excess of bits [0, i] of `bits`
+        inline __m256i prefix_excess_256(uint32_t bits, int carry) {
+            __m256i exc = steps_256(bits);
+            // prefix sums in each 16-byte lane
+            exc = _mm256_add_epi8(exc, _mm256_slli_si256(exc, 1));
+            exc = _mm256_add_epi8(exc, _mm256_slli_si256(exc, 2));
+            exc = _mm256_add_epi8(exc, _mm256_slli_si256(exc, 4));
+            exc = _mm256_add_epi8(exc, _mm256_slli_si256(exc, 8));
+            // total of the low lane, moved to the high lane
+            __m256i low_total = _mm256_shuffle_epi8(exc, _mm256_set1_epi8(15));
+            low_total = _mm256_permute2x128_si256(low_total, low_total, 0x08);
+            return _mm256_add_epi8(exc, _mm256_add_epi8(low_total, _mm256_set1_epi8(char(carry))));
+        }
+
+        // byte i: `carry` + excess of bits [i, 31] of `bits`
+        inline __m256i suffix_excess_256(uint32_t bits, int carry) {
+            __m256i exc = steps_256(bits);
+            exc = _mm256_add_epi8(exc, _mm256_srli_si256(exc, 1));
+            exc = _mm256_add_epi8(exc, _mm256_srli_si256(exc, 2));
+            exc = _mm256_add_epi8(exc, _mm256_srli_si256(exc, 4));
+            exc = _mm256_add_epi8(exc, _mm256_srli_si256(exc, 8));
+            // total of the high lane, moved to the low lane
+            __m256i high_total = _mm256_shuffle_epi8(exc, _mm256_setzero_si256());
+            high_total = _mm256_permute2x128_si256(high_total, high_total, 0x81);
+            return _mm256_add_epi8(exc, _mm256_add_epi8(high_total, _mm256_set1_epi8(char(carry))));
+        }
+
+        inline int word_excess(uint32_t bits) {
+            return 2 * int(util::popcount(bits)) - 32;
+        }
+
+        inline uint64_t equal_bytes_256(__m256i lo, __m256i hi, int value) {
+            const __m256i v = _mm256_set1_epi8(char(value));
+            return uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, v)))) |
+                   (uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, v)))) << 32);
+        }
+
+        inline int min_byte_256(__m256i v) {
+            __m128i m = _mm_min_epi8(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+            m = _mm_min_epi8(m, _mm_srli_si128(m, 8));
+            m = _mm_min_epi8(m, _mm_srli_si128(m, 4));
+            m = _mm_min_epi8(m, _mm_srli_si128(m, 2));
+            m = _mm_min_epi8(m, _mm_srli_si128(m, 1));
+            return int8_t(_mm_cvtsi128_si32(m));
+        }
+
+        // `prefix_min`: min excess of the positions after each bit, the
+        // position before bit 0 (excess 0) is part of the range as in the
+        // table kernel, where it wins the ties.
+        inline void update_rmq(uint64_t min_positions, int prefix_min,
+                               BpVector::excess_t& exc, uint64_t word_start,
+                               BpVector::excess_t& min_exc, uint64_t& min_exc_idx) {
+            int word_min = std::min(prefix_min, 0);
+            if (exc + word_min < min_exc) {
+                min_exc = exc + word_min;
+                min_exc_idx = word_start + (word_min ? util::lsb(min_positions) + 1 : 0);
+            }
+        }
+    }
+
+    bool avx2_find_open_in_word(uint64_t word, uint64_t,
+                                BpVector::excess_t cur_exc, uint64_t& ret) {
+        assert(cur_exc > 0 && cur_exc <= 64);
+        uint32_t high = uint32_t(word >> 32);
+        __m256i hi = suffix_excess_256(high, 0);
+        __m256i lo = suffix_excess_256(uint32_t(word), word_excess(high));
+        unsigned long pos;
+        if (util::msb(equal_bytes_256(lo, hi, cur_exc), pos)) {
+            ret = pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool avx2_find_close_in_word(uint64_t word, uint64_t,
+                                 BpVector::excess_t cur_exc, uint64_t& ret) {
+        assert(cur_exc > 0 && cur_exc <= 64);
+        uint32_t low = uint32_t(word);
+        __m256i lo = prefix_excess_256(low, 0);
+        __m256i hi = prefix_excess_256(uint32_t(word >> 32), word_excess(low));
+        unsigned long pos;
+        if (util::lsb(equal_bytes_256(lo, hi, -cur_exc), pos)) {
+            ret = pos;
+            return true;
+        }
+        return false;
+    }
+
+    void avx2_excess_rmq_in_word(uint64_t word, BpVector::excess_t& exc, uint64_t word_start,
+                                 BpVector::excess_t& min_exc, uint64_t& min_exc_idx) {
+        uint32_t low = uint32_t(word);
+        __m256i lo = prefix_excess_256(low, 0);
+        __m256i hi = prefix_excess_256(uint32_t(word >> 32), word_excess(low));
+        int prefix_min = min_byte_256(_mm256_min_epi8(lo, hi));
+        update_rmq(equal_bytes_256(lo, hi, prefix_min), prefix_min, exc, word_start, min_exc, min_exc_idx);
+        exc += 2 * BpVector::excess_t(util::popcount(word)) - 64;
+    }
+
+#ifdef PDT_HW_AVX512BW
+    namespace {
+        // byte i: excess of bits [0, i] of `word`
+        inline __m512i prefix_excess_512(uint64_t word) {
+            const __m512i zero = _mm512_setzero_si512();
+            __m512i exc = _mm512_mask_blend_epi8(word, _mm512_set1_epi8(-1), _mm512_set1_epi8(1));
+            // prefix sums in each 16-byte lane
+            exc = _mm512_add_epi8(exc, _mm512_bslli_epi128(exc, 1));
+            exc = _mm512_add_epi8(exc, _mm512_bslli_epi128(exc, 2));
+            exc = _mm512_add_epi8(exc, _mm512_bslli_epi128(exc, 4));
+            exc = _mm512_add_epi8(exc, _mm512_bslli_epi128(exc, 8));
+            // add the totals of the lower lanes (a lane is 2 qwords)
+            __m512i totals = _mm512_shuffle_epi8(exc, _mm512_set1_epi8(15));
+            totals = _mm512_add_epi8(totals, _mm512_alignr_epi64(totals, zero, 6));
+            totals = _mm512_add_epi8(totals, _mm512_alignr_epi64(totals, zero, 4));
+            return _mm512_add_epi8(exc, _mm512_alignr_epi64(totals, zero, 6));
+        }
+
+        // byte i: excess of bits [i, 63] of `word`
+        inline __m512i suffix_excess_512(uint64_t word) {
+            const __m512i zero = _mm512_setzero_si512();
+            __m512i exc = _mm512_mask_blend_epi8(word, _mm512_set1_epi8(-1), _mm512_set1_epi8(1));
+            exc = _mm512_add_epi8(exc, _mm512_bsrli_epi128(exc, 1));
+            exc = _mm512_add_epi8(exc, _mm512_bsrli_epi128(exc, 2));
+            exc = _mm512_add_epi8(exc, _mm512_bsrli_epi128(exc, 4));
+            exc = _mm512_add_epi8(exc, _mm512_bsrli_epi128(exc, 8));
+            // add the totals of the higher lanes
+            __m512i totals = _mm512_shuffle_epi8(exc, zero);
+            totals = _mm512_add_epi8(totals, _mm512_alignr_epi64(zero, totals, 2));
+            totals = _mm512_add_epi8(totals, _mm512_alignr_epi64(zero, totals, 4));
+            return _mm512_add_epi8(exc, _mm512_alignr_epi64(zero, totals, 2));
+        }
+    }
+
+    bool avx512_find_open_in_word(uint64_t word, uint64_t,
+                                  BpVector::excess_t cur_exc, uint64_t& ret) {
+        assert(cur_exc > 0 && cur_exc <= 64);
+        uint64_t found = _mm512_cmpeq_epi8_mask(suffix_excess_512(word), _mm512_set1_epi8(char(cur_exc)));
+        unsigned long pos;
+        if (util::msb(found, pos)) {
+            ret = pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool avx512_find_close_in_word(uint64_t word, uint64_t,
+                                   BpVector::excess_t cur_exc, uint64_t& ret) {
+        assert(cur_exc > 0 && cur_exc <= 64);
+        uint64_t found = _mm512_cmpeq_epi8_mask(prefix_excess_512(word), _mm512_set1_epi8(char(-cur_exc)));
+        unsigned long pos;
+        if (util::lsb(found, pos)) {
+            ret = pos;
+            return true;
+        }
+        return false;
+    }
+
+    void avx512_excess_rmq_in_word(uint64_t word, BpVector::excess_t& exc, uint64_t word_start,
+                                   BpVector::excess_t& min_exc, uint64_t& min_exc_idx) {
+        __m512i prefix = prefix_excess_512(word);
+        int prefix_min = min_byte_256(_mm256_min_epi8(_mm512_castsi512_si256(prefix),
+                                                      _mm512_extracti64x4_epi64(prefix, 1)));
+        uint64_t min_positions = _mm512_cmpeq_epi8_mask(prefix, _mm512_set1_epi8(char(prefix_min)));
+        update_rmq(min_positions, prefix_min, exc, word_start, min_exc, min_exc_idx);
+        exc += 2 * BpVector::excess_t(util::popcount(word)) - 64;
+    }
+#endif
+#endif
+
+    const char* bp_word_kernel() {
+#if defined(PDT_HW_AVX512BW)
+        return "avx512bw";
+#elif defined(PDT_HW_AVX2)
+        return "avx2";
+#else
+        return "table";
+#endif
+    }
+
     bool find_open_in_word(
             uint64_t word, uint64_t byte_counts,
             BpVector::excess_t cur_exc, uint64_t& ret) {
+#if defined(PDT_HW_AVX512BW)
+        return avx512_find_open_in_word(word, byte_counts, cur_exc, ret);
+#elif defined(PDT_HW_AVX2)
+        return avx2_find_open_in_word(word, byte_counts, cur_exc, ret);
+#else
+        return table_find_open_in_word(word, byte_counts, cur_exc, ret);
+#endif
+    }
+
+    bool find_close_in_word(
+            uint64_t word, uint64_t byte_counts,
+            BpVector::excess_t cur_exc, uint64_t& ret) {
+#if defined(PDT_HW_AVX512BW)
+        return avx512_find_close_in_word(word, byte_counts, cur_exc, ret);
+#elif defined(PDT_HW_AVX2)
+        return avx2_find_close_in_word(word, byte_counts, cur_exc, ret);
+#else
+        return table_find_close_in_word(word, byte_counts, cur_exc, ret);
+#endif
+    }
+
+    void excess_rmq_in_word(uint64_t word, BpVector::excess_t& exc, uint64_t word_start,
+                            BpVector::excess_t& min_exc, uint64_t& min_exc_idx) {
+#if defined(PDT_HW_AVX512BW)
+        avx512_excess_rmq_in_word(word, exc, word_start, min_exc, min_exc_idx);
+#elif defined(PDT_HW_AVX2)
+        avx2_excess_rmq_in_word(word, exc, word_start, min_exc, min_exc_idx);
+#else
+        table_excess_rmq_in_word(word, exc, word_start, min_exc, min_exc_idx);
+#endif
+    }
+
+    bool table_find_open_in_word(
+            uint64_t word, uint64_t byte_counts,
+            BpVector::excess_t cur_exc, uint64_t& ret) {
         assert(cur_exc > 0 && cur_exc <= 64);
         const uint64_t rev_byte_counts = util::reverse_bytes(byte_counts);
         const uint64_t cum_exc_step_8 =
@@ -99,8 +335,9 @@ namespace succinct {
     }
 
     // search in the block index range `block_offset + [0, start - 1]`
-    inline bool BpVector::find_open_in_block(
-            uint64_t block_offset, BpVector::excess_t excess, uint64_t start, uint64_t& ret) const {
+    template <typename RsBitVectorType, uint64_t BpBlockSize, uint64_t SuperblockSize>
+    inline bool BasicBpVector<RsBitVectorType, BpBlockSize, SuperblockSize>::find_open_in_block(
+            uint64_t block_offset, excess_t excess, uint64_t start, uint64_t& ret) const {
         // `excess` is the number of ")" that is mismatched.
         // `excess` > start * 64 means that even if all the remaining bits are 1,
         // the "(" we need to look for is not in local block.
@@ -113,8 +350,9 @@ namespace succinct {
 
         for (uint64_t sub_block_offset = start - 1; sub_block_offset + 1 > 0; --sub_block_offset) {
             assert(excess > 0);
+            PDT_COUNT(BP_BLOCK_WORDS);
             uint64_t sub_block = block_offset + sub_block_offset;
-            uint64_t word = m_bits_[sub_block];
+            uint64_t word = word_at(sub_block);
             uint64_t byte_counts = util::byte_counts(word);
             if (excess <= 64) {
                 if (find_open_in_word(word, byte_counts, excess, ret)) {
@@ -130,8 +368,9 @@ namespace succinct {
     // `direction`: backward when direction = 0.
     // `block`: block index
     // `excess`: the excess in bit index range [0, pos)
+    template <typename RsBitVectorType, uint64_t BpBlockSize, uint64_t SuperblockSize>
     template <int direction>
-    inline bool BpVector::search_block_in_superblock(
+    inline bool BasicBpVector<RsBitVectorType, BpBlockSize, SuperblockSize>::search_block_in_superblock(
             uint64_t block, excess_t excess, size_t& found_block) const {
         size_t superblock = block / superblock_size;
         excess_t superblock_excess = get_block_excess(superblock * superblock_size);
@@ -139,6 +378,7 @@ namespace succinct {
             for (size_t cur_block = block;
                  cur_block < std::min((superblock + 1) * superblock_size, (size_t)m_block_excess_min_.size());
                  ++cur_block) {
+                PDT_COUNT(BP_SUPERBLOCK_STEPS);
                 if (excess >= superblock_excess + m_block_excess_min_[cur_block]) {
                     found_block = cur_block;
                     return true;
@@ -148,6 +388,7 @@ namespace succinct {
             for (size_t cur_block = block;
                  cur_block + 1 >= (superblock * superblock_size) + 1;
                  --cur_block) {
+                PDT_COUNT(BP_SUPERBLOCK_STEPS);
                 if (excess >= superblock_excess + m_block_excess_min_[cur_block]) {
                     found_block = cur_block;
                     return true;
@@ -158,13 +399,15 @@ namespace succinct {
         return false;
     }
 
-    inline bool BpVector::in_node_range(uint64_t node, excess_t excess) const {
+    template <typename RsBitVectorType, uint64_t BpBlockSize, uint64_t SuperblockSize>
+    inline bool BasicBpVector<RsBitVectorType, BpBlockSize, SuperblockSize>::in_node_range(uint64_t node, excess_t excess) const {
         assert(m_superblock_excess_min_[node] != excess_t(size()));
         return excess >= m_superblock_excess_min_[node];
     }
 
+    template <typename RsBitVectorType, uint64_t BpBlockSize, uint64_t SuperblockSize>
     template <int direction>
-    inline uint64_t BpVector::search_min_tree(uint64_t block, excess_t excess) const {
+    inline uint64_t BasicBpVector<RsBitVectorType, BpBlockSize, SuperblockSize>::search_min_tree(uint64_t block, excess_t excess) const {
         size_t found_block = -1U;
         if (search_block_in_superblock<direction>(block, excess, found_block)) {
             return found_block;
@@ -174,6 +417,7 @@ namespace succinct {
         size_t cur_superblock = block / superblock_size;
         size_t cur_node = m_internal_nodes_ + cur_superblock;
         while (true) {
+            PDT_COUNT(BP_TREE_STEPS);
             assert(cur_node);
             // left sub-tree or right sub-tree
             bool going_back = (cur_node & 1) == direction;
@@ -197,6 +441,7 @@ namespace succinct {
 
         // sliding down `m_superblock_excess_min_` binary tree for searching the superblock.
         while (cur_node < m_internal_nodes_) {
+            PDT_COUNT(BP_TREE_STEPS);
             uint64_t next_node = cur_node * 2 + (1 - direction);
             if (in_node_range(next_node, excess)) {
                 cur_node = next_node;
@@ -218,14 +463,16 @@ namespace succinct {
     }
 
     // `pos`: bit index
-    uint64_t BpVector::find_open(uint64_t pos) const {
+    template <typename RsBitVectorType, uint64_t BpBlockSize, uint64_t SuperblockSize>
+    uint64_t BasicBpVector<RsBitVectorType, BpBlockSize, SuperblockSize>::find_open(uint64_t pos) const {
         assert(pos);
+        PDT_COUNT(FIND_OPEN);
         uint64_t ret = -1U;
         // Search in current word
         uint64_t word_pos = (pos / 64);
         uint64_t len = pos % 64;
         // Rest is padded with "close"
-        uint64_t shifted_word = -(len != 0) & (m_bits_[word_pos] << (64 - len));
+        uint64_t shifted_word = -(len != 0) & (word_at(word_pos) << (64 - len));
         uint64_t byte_counts = util::byte_counts(shifted_word);
 
         excess_t word_exc = 1;
@@ -235,6 +482,7 @@ namespace succinct {
         }
 
         // Otherwise search in the local block
+        PDT_COUNT(BP_IN_BLOCK);
         uint64_t block = word_pos / bp_block_size;
         uint64_t block_offset = block * bp_block_size;
         uint64_t sub_block = word_pos % bp_block_size;
@@ -245,6 +493,7 @@ namespace succinct {
         }
 
         // Otherwise, find the first appropriate block
+        PDT_COUNT(BP_MIN_TREE);
         excess_t pos_excess = excess(pos) - 1;
         uint64_t found_block = search_min_tree<0>(block - 1, pos_excess);
         uint64_t found_block_offset = found_block * bp_block_size;
@@ -257,7 +506,7 @@ namespace succinct {
         return ret;
     }
 
-    bool find_close_in_word(
+    bool table_find_close_in_word(
             uint64_t word, uint64_t byte_counts,
             BpVector::excess_t cur_exc, uint64_t& ret) {
         assert(cur_exc > 0 && cur_exc <= 64);
@@ -282,16 +531,18 @@ namespace succinct {
         return false;
     }
 
-    inline bool BpVector::find_close_in_block(
-            uint64_t block_offset, BpVector::excess_t excess,
+    template <typename RsBitVectorType, uint64_t BpBlockSize, uint64_t SuperblockSize>
+    inline bool BasicBpVector<RsBitVectorType, BpBlockSize, SuperblockSize>::find_close_in_block(
+            uint64_t block_offset, excess_t excess,
             uint64_t start, uint64_t& ret) const {
         if (excess > excess_t((bp_block_size - start) * 64)) {
             return false;
         }
         assert(excess > 0);
         for (uint64_t sub_block_offset = start; sub_block_offset < bp_block_size; ++sub_block_offset) {
+            PDT_COUNT(BP_BLOCK_WORDS);
             uint64_t sub_block = block_offset + sub_block_offset;
-            uint64_t word = m_bits_[sub_block];
+            uint64_t word = word_at(sub_block);
             uint64_t byte_counts = util::byte_counts(word);
             assert(excess > 0);
             if (excess <= 64) {
@@ -305,13 +556,15 @@ namespace succinct {
         return false;
     }
 
-    uint64_t BpVector::find_close(uint64_t pos) const {
+    template <typename RsBitVectorType, uint64_t BpBlockSize, uint64_t SuperblockSize>
+    uint64_t BasicBpVector<RsBitVectorType, BpBlockSize, SuperblockSize>::find_close(uint64_t pos) const {
         assert((*this)[pos]); // check there is an opening parenthesis in pos
+        PDT_COUNT(FIND_CLOSE);
         uint64_t ret = -1U;
         // Search in current word
         uint64_t word_pos = (pos + 1) / 64;
         uint64_t shift = (pos + 1) % 64;
-        uint64_t shifted_word = m_bits_[word_pos] >> shift;
+        uint64_t shifted_word = word_at(word_pos) >> shift;
         // Pad with "open"
         uint64_t padded_word = shifted_word | (-(shift != 0) & (~0ULL << (64 - shift)));
         uint64_t byte_counts = util::byte_counts(padded_word);
@@ -323,6 +576,7 @@ namespace succinct {
         }
 
         // Otherwise search in the local block
+        PDT_COUNT(BP_IN_BLOCK);
         uint64_t block = word_pos / bp_block_size;
         uint64_t block_offset = block * bp_block_size;
         uint64_t sub_block = word_pos % bp_block_size;
@@ -333,6 +587,7 @@ namespace succinct {
         }
 
         // Otherwise, find the first appropriate block
+        PDT_COUNT(BP_MIN_TREE);
         excess_t pos_excess = excess(pos);
         uint64_t found_block = search_min_tree<1>(block + 1, pos_excess);
         uint64_t found_block_offset = found_block * bp_block_size;
@@ -346,9 +601,8 @@ namespace succinct {
 
     // `word_start`: bit index
     // search in byte step.
-    inline void
-    excess_rmq_in_word(uint64_t word, BpVector::excess_t& exc, uint64_t word_start,
-                       BpVector::excess_t& min_exc, uint64_t& min_exc_idx) {
+    void table_excess_rmq_in_word(uint64_t word, BpVector::excess_t& exc, uint64_t word_start,
+                                  BpVector::excess_t& min_exc, uint64_t& min_exc_idx) {
         BpVector::excess_t min_byte_exc = min_exc;
         uint64_t min_byte_idx = 0;
 
@@ -371,24 +625,26 @@ namespace succinct {
     }
 
     // [start, end), search in word step.
-    void BpVector::excess_rmq_in_block(uint64_t start, uint64_t end,
-                             BpVector::excess_t& exc,
-                             BpVector::excess_t& min_exc,
+    template <typename RsBitVectorType, uint64_t BpBlockSize, uint64_t SuperblockSize>
+    void BasicBpVector<RsBitVectorType, BpBlockSize, SuperblockSize>::excess_rmq_in_block(uint64_t start, uint64_t end,
+                             excess_t& exc,
+                             excess_t& min_exc,
                              uint64_t& min_exc_idx) const {
         assert(start <= end);
         if (start == end) return;
 
         assert((start / bp_block_size) == ((end - 1) / bp_block_size));
         for (size_t w = start; w < end; ++w) {
-            excess_rmq_in_word(m_bits_[w], exc, w * 64,
+            excess_rmq_in_word(word_at(w), exc, w * 64,
                                min_exc, min_exc_idx);
         }
     }
 
     // [block_start, block_end), search in block step.
-    void BpVector::excess_rmq_in_superblock(
+    template <typename RsBitVectorType, uint64_t BpBlockSize, uint64_t SuperblockSize>
+    void BasicBpVector<RsBitVectorType, BpBlockSize, SuperblockSize>::excess_rmq_in_superblock(
             uint64_t block_start, uint64_t block_end,
-            BpVector::excess_t& block_min_exc,
+            excess_t& block_min_exc,
             uint64_t& block_min_idx) const
     {
         assert(block_start <= block_end);
@@ -409,8 +665,9 @@ namespace succinct {
 
     // RMQ Algorithm
     // [superblock_start, superblock_end)
-    void BpVector::find_min_superblock(uint64_t superblock_start, uint64_t superblock_end,
-                                   BpVector::excess_t& superblock_min_exc,
+    template <typename RsBitVectorType, uint64_t BpBlockSize, uint64_t SuperblockSize>
+    void BasicBpVector<RsBitVectorType, BpBlockSize, SuperblockSize>::find_min_superblock(uint64_t superblock_start, uint64_t superblock_end,
+                                   excess_t& superblock_min_exc,
                                    uint64_t& superblock_min_idx) const {
         if (superblock_start == superblock_end) return;
 
@@ -510,8 +767,10 @@ namespace succinct {
 
     // `a`/`b`: bit index
     // return range [0, pos) where excess is minimum in [a, b).
-    uint64_t BpVector::excess_rmq(uint64_t a, uint64_t b, excess_t& min_exc) const {
+    template <typename RsBitVectorType, uint64_t BpBlockSize, uint64_t SuperblockSize>
+    uint64_t BasicBpVector<RsBitVectorType, BpBlockSize, SuperblockSize>::excess_rmq(uint64_t a, uint64_t b, excess_t& min_exc) const {
         assert(a <= b);
+        PDT_COUNT(EXCESS_RMQ);
 
         excess_t cur_exc = excess(a);
         min_exc = cur_exc;
@@ -528,7 +787,7 @@ namespace succinct {
 
         // search in word_a
         uint64_t shift_a = a % 64;
-        uint64_t shifted_word_a = m_bits_[word_a_idx] >> shift_a;
+        uint64_t shifted_word_a = word_at(word_a_idx) >> shift_a;
         uint64_t subword_len_a = std::min(64 - shift_a, range_len);
 
         // 0 bits should be padded because "0" is ")".
@@ -615,7 +874,7 @@ namespace succinct {
         }
 
         // search in word_b
-        uint64_t word_b = m_bits_[word_b_idx];
+        uint64_t word_b = word_at(word_b_idx);
         uint64_t offset_b = b % 64;
         uint64_t padded_word_b =
                 (offset_b == 0)
@@ -631,12 +890,13 @@ namespace succinct {
         return min_exc_idx;
     }
 
-    void BpVector::build_min_tree() {
+    template <typename RsBitVectorType, uint64_t BpBlockSize, uint64_t SuperblockSize>
+    void BasicBpVector<RsBitVectorType, BpBlockSize, SuperblockSize>::build_min_tree() {
         if (!size()) return;
 
         std::vector<block_min_excess_t> block_excess_min;
         excess_t cur_block_min = 0, cur_superblock_excess = 0;
-        for (uint64_t sub_block = 0; sub_block < m_bits_.size(); ++sub_block) {
+        for (uint64_t sub_block = 0; sub_block < word_count(); ++sub_block) {
             if (sub_block % bp_block_size == 0) {
                 if (sub_block % (bp_block_size * superblock_size) == 0) {
                     cur_superblock_excess = 0;
@@ -648,11 +908,11 @@ namespace succinct {
                     cur_block_min = cur_superblock_excess;
                 }
             }
-            uint64_t word = m_bits_[sub_block];
+            uint64_t word = word_at(sub_block);
             uint64_t mask = 1ULL;
             // for last block stop at bit boundary
             uint64_t n_bits =
-                    (sub_block == m_bits_.size() - 1 && size() % 64)
+                    (sub_block == word_count() - 1 && size() % 64)
                     ? size() % 64
                     : 64;
 
@@ -667,7 +927,7 @@ namespace succinct {
         assert(cur_block_min <= std::numeric_limits<block_min_excess_t>::max());
         block_excess_min.push_back((block_min_excess_t)cur_block_min);
 
-        size_t n_blocks = (m_bits_.size() + bp_block_size - 1) / bp_block_size;
+        size_t n_blocks = (word_count() + bp_block_size - 1) / bp_block_size;
         assert(n_blocks == block_excess_min.size());
 
         size_t n_superblocks = (n_blocks + superblock_size - 1) / superblock_size;
@@ -711,4 +971,14 @@ namespace succinct {
         m_block_excess_min_.steal(block_excess_min);
         m_superblock_excess_min_.steal(superblock_excess_min);
     }
-}
\ No newline at end of file
+
+    // The configurations in use: the default one (BpVector) and the ones
+    // compared by bench/bench_block_sizes.cpp. A new configuration has to be added here.
+    template class BasicBpVector<>;
+    template class BasicBpVector<RsBitVector, 2, 32>;
+    template class BasicBpVector<RsBitVector, 8, 32>;
+    template class BasicBpVector<RsBitVector, 4, 16>;
+    template class BasicBpVector<RsBitVector, 4, 64>;
+    template class BasicBpVector<BasicRsBitVector<4>, 4, 32>;
+    template class BasicBpVector<InterleavedRsBitVector, 4, 32>;
+}
@@ -6,6 +6,8 @@
 #define PATH_DECOMPOSITION_TRIE_BALANCED_PARENTHESES_VECTOR_H
 
 #include "rank_select_bit_vector.h"
+#include "interleaved_rank_select_bit_vector.h"
+#include "darray.h"
 
 namespace succinct {
     //
@@ -53,40 +55,65 @@ namespace succinct {
     //
     // `m_superblock_excess_min_` is used in RMQ algorithm.
     //
-    class BpVector : public RsBitVector {
+    // The rank/select vector, `BpBlockSize` (in 64bit words) and `SuperblockSize`
+    // (in blocks) are template parameters. The member functions are defined in
+    // balanced_parentheses_vector.cpp, which explicitly instantiates the
+    // configurations in use (the default one and the ones of the benchmarks).
+    // The rank/select vector is RsBitVector or InterleavedRsBitVector, the
+    // bits are read through its `word_at()` / `word_count()`.
+    //
+    template <typename RsBitVectorType = RsBitVector,
+              uint64_t BpBlockSize = 4,
+              uint64_t SuperblockSize = 32>
+    class BasicBpVector : public RsBitVectorType {
+        // block minimums are int16_t relative to the superblock start
+        static_assert(BpBlockSize * SuperblockSize * 64 <= 32767, "superblock too large for block_min_excess_t");
+
     public:
-        BpVector() : RsBitVector() {}
+        BasicBpVector() : RsBitVectorType() {}
 
-        BpVector(const std::vector<bool>& bools,
-                 bool with_select_hints = false,
-                 bool with_select0_hints = false)
-                 : RsBitVector(bools, with_select_hints, with_select0_hints) {
+        BasicBpVector(const std::vector<bool>& bools,
+                      bool with_select_hints = false,
+                      bool with_select0_hints = false)
+                      : RsBitVectorType(bools, with_select_hints, with_select0_hints) {
             build_min_tree();
         }
 
-        BpVector(BitVectorBuilder* builder,
-                 bool with_select_hints = false,
-                 bool with_select0_hints = false)
-                 : RsBitVector(builder, with_select_hints, with_select0_hints) {
+        BasicBpVector(BitVectorBuilder* builder,
+                      bool with_select_hints = false,
+                      bool with_select0_hints = false)
+                      : RsBitVectorType(builder, with_select_hints, with_select0_hints) {
             build_min_tree();
         }
 
-        BpVector(const uint64_t* raw_data,
-                 uint64_t word_size,
-                 size_t bit_size,
-                 bool with_select_hints = false,
-                 bool with_select0_hints = false)
-                 : RsBitVector(raw_data, word_size, bit_size, with_select_hints, with_select0_hints) {
+        BasicBpVector(const uint64_t* raw_data,
+                      uint64_t word_size,
+                      size_t bit_size,
+                      bool with_select_hints = false,
+                      bool with_select0_hints = false)
+                      : RsBitVectorType(raw_data, word_size, bit_size, with_select_hints, with_select0_hints) {
             build_min_tree();
         }
 
-        void swap(BpVector& other) {
-            RsBitVector::swap(other);
+        using RsBitVectorType::size;
+        using RsBitVectorType::rank;
+        using RsBitVectorType::word_count;
+        using RsBitVectorType::word_at;
+
+        void swap(BasicBpVector& other) {
+            RsBitVectorType::swap(other);
             std::swap(m_internal_nodes_, other.m_internal_nodes_);
             m_block_excess_min_.swap(other.m_block_excess_min_);
             m_superblock_excess_min_.swap(other.m_superblock_excess_min_);
         }
 
+        SpaceReport space_report() const {
+            SpaceReport report = RsBitVectorType::space_report();
+            report.add("block_excess_min", m_block_excess_min_);
+            report.add("superblock_excess_min", m_superblock_excess_min_);
+            return report;
+        }
+
         uint64_t find_open(uint64_t pos) const;
 
         uint64_t find_close(uint64_t pos) const;
@@ -105,13 +132,15 @@ namespace succinct {
         }
 
     protected:
-        static const size_t bp_block_size = 4; // to increase confusion, bp block_size is not necessarily rs_bit_vector block_size
-        static const size_t superblock_size = 32; // number of blocks in superblock
+        using RsBitVectorType::word_rank;
+
+        static const size_t bp_block_size = BpBlockSize; // to increase confusion, bp block_size is not necessarily rs_bit_vector block_size
+        static const size_t superblock_size = SuperblockSize; // number of blocks in superblock
 
         typedef int16_t block_min_excess_t;
 
         // return true if we can find matched "(" in block, the position is returned by `ret`
-        // `ret` is the bit index relative to `m_bits_`.
+        // `ret` is the bit index in the bit vector.
         //
         // `pos`: word index at the boundary of block
         // `excess`: the number of ")" that is mismatched
@@ -123,16 +152,16 @@ namespace succinct {
                                  uint64_t max_sub_blocks, uint64_t& ret) const;
 
         void excess_rmq_in_block(uint64_t start, uint64_t end,
-                                 BpVector::excess_t& exc,
-                                 BpVector::excess_t& min_exc,
+                                 excess_t& exc,
+                                 excess_t& min_exc,
                                  uint64_t& min_exc_idx) const;
 
         void excess_rmq_in_superblock(uint64_t block_start, uint64_t block_end,
-                                      BpVector::excess_t& block_min_exc,
+                                      excess_t& block_min_exc,
                                       uint64_t& block_min_idx) const;
 
         void find_min_superblock(uint64_t superblock_start, uint64_t superblock_end,
-                                 BpVector::excess_t& superblock_min_exc,
+                                 excess_t& superblock_min_exc,
                                  uint64_t& superblock_min_idx) const;
 
         // accumulate the excess in the block index range [0, block)
@@ -167,6 +196,61 @@ namespace succinct {
 
     };
 
+    typedef BasicBpVector<> BpVector;
+
+    //
+    // A BP vector whose select0 (the node lookup of the trie) reads the
+    // samples of a darray instead of the select0 hints and the binary search
+    // over the rank blocks. The base vector is built without select0 hints.
+    //
+    //     DefaultPathDecomposedTrie<Lexicographic, DarrayBpVector<>>
+    //
+    template <typename BpVectorType = BpVector>
+    class DarrayBpVector : public BpVectorType {
+    public:
+        DarrayBpVector() : BpVectorType() {}
+
+        DarrayBpVector(const std::vector<bool>& bools,
+                       bool with_select_hints = false,
+                       bool /* with_select0_hints */ = false)
+                       : BpVectorType(bools, with_select_hints, false)
+                       , m_select0_(static_cast<const BpVectorType&>(*this)) {}
+
+        DarrayBpVector(BitVectorBuilder* builder,
+                       bool with_select_hints = false,
+                       bool /* with_select0_hints */ = false)
+                       : BpVectorType(builder, with_select_hints, false)
+                       , m_select0_(static_cast<const BpVectorType&>(*this)) {}
+
+        DarrayBpVector(const uint64_t* raw_data,
+                       uint64_t word_size,
+                       size_t bit_size,
+                       bool with_select_hints = false,
+                       bool /* with_select0_hints */ = false)
+                       : BpVectorType(raw_data, word_size, bit_size, with_select_hints, false)
+                       , m_select0_(static_cast<const BpVectorType&>(*this)) {}
+
+        void swap(DarrayBpVector& other) {
+            BpVectorType::swap(other);
+            m_select0_.swap(other.m_select0_);
+        }
+
+        SpaceReport space_report() const {
+            SpaceReport report = BpVectorType::space_report();
+            report.add("select0_darray", m_select0_.space_report());
+            return report;
+        }
+
+        // get `n`-th 0-bit's position in bits
+        // `n` starts from 0
+        inline uint64_t select0(uint64_t n) const {
+            return m_select0_.select(static_cast<const BpVectorType&>(*this), n);
+        }
+
+    private:
+        Darray0 m_select0_;
+    };
+
     // return true if we can find matched "(" in word, the position is returned by `ret`
     // `ret` is the bit index relative to `word`.
     //
@@ -184,6 +268,38 @@ namespace succinct {
 
     void excess_rmq_in_word(uint64_t word, BpVector::excess_t& exc, uint64_t word_start,
                        BpVector::excess_t& min_exc, uint64_t& min_exc_idx);
+
+    // The in-word kernels above dispatch at compile time (see PDT_HW_* in
+    // bit_util.h) to one of the following, which are also exported for the
+    // cross-check tests:
+    //   - table_*:  byte by byte through the 256-entry excess tables (portable)
+    //   - avx2_*:   per-bit prefix excess of the word in two 32-byte vectors
+    //   - avx512_*: the same in one 64-byte vector
+    // The vector kernels ignore `byte_counts`.
+    const char* bp_word_kernel();
+
+    bool table_find_open_in_word(uint64_t word, uint64_t byte_counts,
+                                 BpVector::excess_t cur_exc, uint64_t& ret);
+    bool table_find_close_in_word(uint64_t word, uint64_t byte_counts,
+                                  BpVector::excess_t cur_exc, uint64_t& ret);
+    void table_excess_rmq_in_word(uint64_t word, BpVector::excess_t& exc, uint64_t word_start,
+                                  BpVector::excess_t& min_exc, uint64_t& min_exc_idx);
+#ifdef PDT_HW_AVX2
+    bool avx2_find_open_in_word(uint64_t word, uint64_t byte_counts,
+                                BpVector::excess_t cur_exc, uint64_t& ret);
+    bool avx2_find_close_in_word(uint64_t word, uint64_t byte_counts,
+                                 BpVector::excess_t cur_exc, uint64_t& ret);
+    void avx2_excess_rmq_in_word(uint64_t word, BpVector::excess_t& exc, uint64_t word_start,
+                                 BpVector::excess_t& min_exc, uint64_t& min_exc_idx);
+#endif
+#ifdef PDT_HW_AVX512BW
+    bool avx512_find_open_in_word(uint64_t word, uint64_t byte_counts,
+                                  BpVector::excess_t cur_exc, uint64_t& ret);
+    bool avx512_find_close_in_word(uint64_t word, uint64_t byte_counts,
+                                   BpVector::excess_t cur_exc, uint64_t& ret);
+    void avx512_excess_rmq_in_word(uint64_t word, BpVector::excess_t& exc, uint64_t word_start,
+                                   BpVector::excess_t& min_exc, uint64_t& min_exc_idx);
+#endif
 }
 
 #endif //PATH_DECOMPOSITION_TRIE_BALANCED_PARENTHESES_VECTOR_H
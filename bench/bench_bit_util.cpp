@@ -0,0 +1,130 @@
+//
+// Word-level primitives of bit_util.h: the broadword code against the
+// hardware instructions, and the `util::` functions as dispatched in this
+// build (see PDT_HW_* in bit_util.h).
+//
+// The x86-64 hardware variants are compiled with target attributes and run
+// only if cpuid reports the instructions, so they are compared even when the
+// build itself is portable.
+//
+
+#include "bench_util.h"
+#include "bit_util.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define PDT_BENCH_X86 1
+#endif
+
+using namespace succinct;
+
+static const size_t N_WORDS = 4096;
+
+struct Input {
+    std::vector<uint64_t> words;
+    std::vector<uint64_t> ks;       // ks[i] < popcount(words[i])
+};
+
+static const Input& get_input() {
+    static Input input;
+    if (input.words.empty()) {
+        std::mt19937_64 rng(42);
+        for (size_t i = 0; i < N_WORDS; ++i) {
+            uint64_t w = rng() | 1;
+            input.words.push_back(w);
+            input.ks.push_back(rng() % util::broadword_popcount(w));
+        }
+    }
+    return input;
+}
+
+struct Broadword {
+    static uint64_t popcount(uint64_t x) { return util::broadword_popcount(x); }
+    static uint64_t msb(uint64_t x) { unsigned long r = 0; util::broadword_msb(x, r); return r; }
+    static uint64_t lsb(uint64_t x) { unsigned long r = 0; util::broadword_lsb(x, r); return r; }
+    static uint64_t select(uint64_t x, uint64_t k) { return util::broadword_select_in_word(x, k); }
+    static bool supported() { return true; }
+};
+
+struct Dispatched {
+    static uint64_t popcount(uint64_t x) { return util::popcount(x); }
+    static uint64_t msb(uint64_t x) { unsigned long r = 0; util::msb(x, r); return r; }
+    static uint64_t lsb(uint64_t x) { unsigned long r = 0; util::lsb(x, r); return r; }
+    static uint64_t select(uint64_t x, uint64_t k) { return util::select_in_word(x, k); }
+    static bool supported() { return true; }
+};
+
+#ifdef PDT_BENCH_X86
+struct Hardware {
+    __attribute__((target("popcnt")))
+    static uint64_t popcount(uint64_t x) { return __builtin_popcountll(x); }
+    __attribute__((target("lzcnt")))
+    static uint64_t msb(uint64_t x) { return 63 - _lzcnt_u64(x); }
+    __attribute__((target("bmi")))
+    static uint64_t lsb(uint64_t x) { return _tzcnt_u64(x); }
+    __attribute__((target("bmi,bmi2")))
+    static uint64_t select(uint64_t x, uint64_t k) { return _tzcnt_u64(_pdep_u64(1ULL << k, x)); }
+    static bool supported() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("popcnt") && __builtin_cpu_supports("bmi") &&
+               __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("lzcnt");
+    }
+};
+#endif
+
+// Every iteration runs the primitive on all N_WORDS words; the results are
+// summed so that the calls are independent (throughput, not latency).
+template <typename Impl, typename Fn>
+static void run_words(benchmark::State& state, Fn fn) {
+    if (!Impl::supported()) {
+        state.SkipWithError("instructions not supported by this CPU");
+        return;
+    }
+    const auto& input = get_input();
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < N_WORDS; ++i) {
+            sum += fn(input.words[i], input.ks[i]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * N_WORDS);
+}
+
+template <typename Impl>
+static void BM_Popcount(benchmark::State& state) {
+    run_words<Impl>(state, [](uint64_t x, uint64_t) { return Impl::popcount(x); });
+}
+
+template <typename Impl>
+static void BM_Msb(benchmark::State& state) {
+    run_words<Impl>(state, [](uint64_t x, uint64_t) { return Impl::msb(x); });
+}
+
+template <typename Impl>
+static void BM_Lsb(benchmark::State& state) {
+    run_words<Impl>(state, [](uint64_t x, uint64_t) { return Impl::lsb(x); });
+}
+
+template <typename Impl>
+static void BM_SelectInWord(benchmark::State& state) {
+    run_words<Impl>(state, [](uint64_t x, uint64_t k) { return Impl::select(x, k); });
+}
+
+#ifdef PDT_BENCH_X86
+#define BIT_UTIL_IMPLS(bm)                  \
+    BENCHMARK_TEMPLATE(bm, Broadword);      \
+    BENCHMARK_TEMPLATE(bm, Hardware);       \
+    BENCHMARK_TEMPLATE(bm, Dispatched)
+#else
+#define BIT_UTIL_IMPLS(bm)                  \
+    BENCHMARK_TEMPLATE(bm, Broadword);      \
+    BENCHMARK_TEMPLATE(bm, Dispatched)
+#endif
+
+BIT_UTIL_IMPLS(BM_Popcount);
+BIT_UTIL_IMPLS(BM_Msb);
+BIT_UTIL_IMPLS(BM_Lsb);
+BIT_UTIL_IMPLS(BM_SelectInWord);
+
+BENCHMARK_MAIN();
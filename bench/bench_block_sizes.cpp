@@ -0,0 +1,150 @@
+//
+// Space/time matrix of the block size configurations of BasicRsBitVector
+// and BasicBpVector, and of InterleavedRsBitVector. Each benchmark reports
+// the directory overhead (`overhead_pct`, directory bytes / bit bytes * 100)
+// next to its latency. The cold-cache runs compare the rank counters
+// interleaved with the bits against the separate RsBitVector directory.
+//
+// The bit vector size is PDT_BENCH_MATRIX_BITS (default 10M).
+//
+
+#include "bench_util.h"
+#include "balanced_parentheses_vector.h"
+
+static const size_t N_QUERIES = 1 << 16;
+
+static size_t matrix_bits() {
+    return bench::env_uint("PDT_BENCH_MATRIX_BITS", 10000000);
+}
+
+static void matrix_sizes(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"bits", "cold"});
+    b->Args({static_cast<int64_t>(matrix_bits()), 0});
+}
+
+static void cold_matrix_sizes(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"bits", "cold"});
+    b->Iterations(static_cast<int64_t>(bench::env_uint("PDT_BENCH_COLD_ITERS", 200)));
+    b->UseManualTime();
+    b->Args({static_cast<int64_t>(matrix_bits()), 1});
+}
+
+// random bits with 1/2 density
+static void random_bits(succinct::BitVectorBuilder& builder, size_t n) {
+    std::mt19937_64 rng(n);
+    builder.reserve(n);
+    for (size_t i = 0; i < n; i += 64) {
+        size_t len = std::min<size_t>(64, n - i);
+        uint64_t bits = rng();
+        builder.append_bits(len == 64 ? bits : bits & ((1ULL << len) - 1), len);
+    }
+}
+
+// a random balanced parentheses sequence of (about) `n` bits
+static void random_bp(succinct::BitVectorBuilder& builder, size_t n) {
+    std::mt19937_64 rng(n);
+    n += n % 2;
+    builder.reserve(n);
+    uint64_t excess = 0;
+    for (size_t i = 0; i < n; ++i) {
+        bool open = excess == 0 || (excess != n - i && (rng() & 1));
+        builder.push_back(open);
+        excess += open ? 1 : -1;
+    }
+}
+
+template <typename T>
+static const T& get_vector(bool balanced) {
+    static std::unique_ptr<T> v;
+    if (!v) {
+        succinct::BitVectorBuilder builder;
+        if (balanced) {
+            random_bp(builder, matrix_bits());
+        } else {
+            random_bits(builder, matrix_bits());
+        }
+        v.reset(new T(&builder, true, true));
+    }
+    return *v;
+}
+
+template <typename T>
+static void report_overhead(benchmark::State& state, const T& v) {
+    succinct::SpaceReport report = v.space_report();
+    double bits = report.bytes("bits");
+    state.counters["overhead_pct"] = (report.total_bytes() - bits) / bits * 100;
+}
+
+template <typename T>
+static void BM_Rank(benchmark::State& state) {
+    const auto& bv = get_vector<T>(false);
+    auto queries = bench::random_positions(N_QUERIES, bv.size());
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(bv.rank(queries[i % N_QUERIES]));
+    });
+    report_overhead(state, bv);
+}
+
+template <typename T>
+static void BM_Select(benchmark::State& state) {
+    const auto& bv = get_vector<T>(false);
+    auto queries = bench::random_positions(N_QUERIES, bv.num_ones());
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(bv.select(queries[i % N_QUERIES]));
+    });
+    report_overhead(state, bv);
+}
+
+template <typename T>
+static void BM_Select0(benchmark::State& state) {
+    const auto& bv = get_vector<T>(false);
+    auto queries = bench::random_positions(N_QUERIES, bv.num_zeros());
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(bv.select0(queries[i % N_QUERIES]));
+    });
+    report_overhead(state, bv);
+}
+
+template <typename T>
+static void BM_FindClose(benchmark::State& state) {
+    const auto& bp = get_vector<T>(true);
+    auto queries = bench::random_positions(N_QUERIES, bp.num_ones());
+    for (auto& q : queries) q = bp.select(q);
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(bp.find_close(queries[i % N_QUERIES]));
+    });
+    report_overhead(state, bp);
+}
+
+using succinct::BasicRsBitVector;
+using succinct::BasicBpVector;
+using succinct::RsBitVector;
+using succinct::InterleavedRsBitVector;
+
+#define RS_CONFIGS(bm)                                                          \
+    BENCHMARK_TEMPLATE(bm, BasicRsBitVector<2>)->Apply(matrix_sizes);           \
+    BENCHMARK_TEMPLATE(bm, BasicRsBitVector<4>)->Apply(matrix_sizes);           \
+    BENCHMARK_TEMPLATE(bm, BasicRsBitVector<4, 4096>)->Apply(matrix_sizes);     \
+    BENCHMARK_TEMPLATE(bm, BasicRsBitVector<8, 640>)->Apply(matrix_sizes);      \
+    BENCHMARK_TEMPLATE(bm, BasicRsBitVector<8>)->Apply(matrix_sizes);           \
+    BENCHMARK_TEMPLATE(bm, BasicRsBitVector<8, 8192>)->Apply(matrix_sizes);     \
+    BENCHMARK_TEMPLATE(bm, InterleavedRsBitVector)->Apply(matrix_sizes);        \
+    BENCHMARK_TEMPLATE(bm, RsBitVector)->Apply(cold_matrix_sizes);              \
+    BENCHMARK_TEMPLATE(bm, InterleavedRsBitVector)->Apply(cold_matrix_sizes)
+
+RS_CONFIGS(BM_Rank);
+RS_CONFIGS(BM_Select);
+RS_CONFIGS(BM_Select0);
+
+// the configurations instantiated in balanced_parentheses_vector.cpp
+BENCHMARK_TEMPLATE(BM_FindClose, BasicBpVector<>)->Apply(matrix_sizes);
+BENCHMARK_TEMPLATE(BM_FindClose, BasicBpVector<RsBitVector, 2, 32>)->Apply(matrix_sizes);
+BENCHMARK_TEMPLATE(BM_FindClose, BasicBpVector<RsBitVector, 8, 32>)->Apply(matrix_sizes);
+BENCHMARK_TEMPLATE(BM_FindClose, BasicBpVector<RsBitVector, 4, 16>)->Apply(matrix_sizes);
+BENCHMARK_TEMPLATE(BM_FindClose, BasicBpVector<RsBitVector, 4, 64>)->Apply(matrix_sizes);
+BENCHMARK_TEMPLATE(BM_FindClose, BasicBpVector<BasicRsBitVector<4>, 4, 32>)->Apply(matrix_sizes);
+BENCHMARK_TEMPLATE(BM_FindClose, BasicBpVector<InterleavedRsBitVector, 4, 32>)->Apply(matrix_sizes);
+BENCHMARK_TEMPLATE(BM_FindClose, BasicBpVector<>)->Apply(cold_matrix_sizes);
+BENCHMARK_TEMPLATE(BM_FindClose, BasicBpVector<InterleavedRsBitVector, 4, 32>)->Apply(cold_matrix_sizes);
+
+BENCHMARK_MAIN();
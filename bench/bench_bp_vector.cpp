@@ -0,0 +1,94 @@
+//
+// find_close / find_open / excess_rmq benchmarks of BpVector, and its
+// select0 (the node lookup of the trie) against the darray of DarrayBpVector.
+//
+
+#include "bench_util.h"
+#include "balanced_parentheses_vector.h"
+
+static const size_t N_QUERIES = 1 << 16;
+
+// a random balanced parentheses sequence of (about) `n` bits
+template <typename BpVectorType = succinct::BpVector>
+static const BpVectorType& get_bp_vector(size_t n) {
+    static std::map<size_t, std::unique_ptr<BpVectorType>> cache;
+    auto it = cache.find(n);
+    if (it == cache.end()) {
+        std::mt19937_64 rng(n);
+        n += n % 2;
+        succinct::BitVectorBuilder builder;
+        builder.reserve(n);
+        uint64_t excess = 0;
+        for (size_t i = 0; i < n; ++i) {
+            bool open;
+            if (excess == 0) {
+                open = true;
+            } else if (excess == n - i) {
+                open = false;
+            } else {
+                open = rng() & 1;
+            }
+            builder.push_back(open);
+            excess += open ? 1 : -1;
+        }
+        it = cache.emplace(n, std::unique_ptr<BpVectorType>(
+                new BpVectorType(&builder, true, true))).first;
+    }
+    return *it->second;
+}
+
+static void BM_FindClose(benchmark::State& state) {
+    const auto& bp = get_bp_vector(state.range(0));
+    auto queries = bench::random_positions(N_QUERIES, bp.num_ones());
+    for (auto& q : queries) q = bp.select(q);
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(bp.find_close(queries[i % N_QUERIES]));
+    });
+}
+
+static void BM_FindOpen(benchmark::State& state) {
+    const auto& bp = get_bp_vector(state.range(0));
+    auto queries = bench::random_positions(N_QUERIES, bp.num_zeros());
+    for (auto& q : queries) q = bp.select0(q);
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(bp.find_open(queries[i % N_QUERIES]));
+    });
+}
+
+static void BM_ExcessRmq(benchmark::State& state) {
+    const auto& bp = get_bp_vector(state.range(0));
+    auto a = bench::random_positions(N_QUERIES, bp.size(), 1);
+    auto b = bench::random_positions(N_QUERIES, bp.size(), 2);
+    for (size_t i = 0; i < N_QUERIES; ++i) {
+        if (a[i] > b[i]) std::swap(a[i], b[i]);
+    }
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(bp.excess_rmq(a[i % N_QUERIES], b[i % N_QUERIES]));
+    });
+}
+
+template <typename BpVectorType>
+static void BM_Select0(benchmark::State& state) {
+    const auto& bp = get_bp_vector<BpVectorType>(state.range(0));
+    auto queries = bench::random_positions(N_QUERIES, bp.num_zeros());
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(bp.select0(queries[i % N_QUERIES]));
+    });
+}
+
+BENCHMARK(BM_FindClose)->Apply(bench::bit_sizes);
+BENCHMARK(BM_FindClose)->Apply(bench::cold_bit_sizes);
+BENCHMARK(BM_FindOpen)->Apply(bench::bit_sizes);
+BENCHMARK(BM_FindOpen)->Apply(bench::cold_bit_sizes);
+BENCHMARK(BM_ExcessRmq)->Apply(bench::bit_sizes);
+BENCHMARK(BM_ExcessRmq)->Apply(bench::cold_bit_sizes);
+BENCHMARK_TEMPLATE(BM_Select0, succinct::BpVector)->Apply(bench::bit_sizes);
+BENCHMARK_TEMPLATE(BM_Select0, succinct::BpVector)->Apply(bench::cold_bit_sizes);
+BENCHMARK_TEMPLATE(BM_Select0, succinct::DarrayBpVector<>)->Apply(bench::bit_sizes);
+BENCHMARK_TEMPLATE(BM_Select0, succinct::DarrayBpVector<>)->Apply(bench::cold_bit_sizes);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,59 @@
+//
+// Search of a symbol in a decreasing run of light branches (branch_search.h):
+// the scalar scan `index()` used before, the vector scan and the branchless
+// binary search, by run width. BRANCH_BINARY_SEARCH_MIN comes from here.
+//
+
+#include "bench_util.h"
+#include "branch_search.h"
+
+static const size_t N_QUERIES = 1 << 12;
+
+struct Runs {
+    std::vector<uint16_t> run;
+    std::vector<uint16_t> queries;      // symbols of the run, uniformly
+};
+
+static const Runs& get_runs(size_t width) {
+    static std::map<size_t, Runs> cache;
+    auto it = cache.find(width);
+    if (it == cache.end()) {
+        Runs r;
+        std::mt19937_64 rng(width);
+        // `width` distinct bytes, decreasing
+        std::vector<uint16_t> bytes(256);
+        for (size_t i = 0; i < 256; ++i) bytes[i] = uint16_t(i);
+        std::shuffle(bytes.begin(), bytes.end(), rng);
+        r.run.assign(bytes.begin(), bytes.begin() + width);
+        std::sort(r.run.rbegin(), r.run.rend());
+        for (size_t i = 0; i < N_QUERIES; ++i) r.queries.push_back(r.run[rng() % width]);
+        it = cache.emplace(width, std::move(r)).first;
+    }
+    return it->second;
+}
+
+static size_t scalar_scan(const uint16_t* branches, size_t n, uint16_t c) {
+    for (size_t i = 0; i < n; ++i) {
+        if (branches[i] == c) return i;
+    }
+    return n;
+}
+
+template <size_t (*Search)(const uint16_t*, size_t, uint16_t)>
+static void BM_BranchSearch(benchmark::State& state) {
+    const auto& r = get_runs(state.range(0));
+    bench::run_ops(state, false, [&](size_t i) {
+        benchmark::DoNotOptimize(Search(r.run.data(), r.run.size(), r.queries[i % N_QUERIES]));
+    });
+}
+
+static void widths(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"width"});
+    for (int w : {2, 4, 8, 16, 32, 48, 64, 128, 255}) b->Arg(w);
+}
+
+BENCHMARK_TEMPLATE(BM_BranchSearch, scalar_scan)->Apply(widths);
+BENCHMARK_TEMPLATE(BM_BranchSearch, succinct::trie::scan_branches)->Apply(widths);
+BENCHMARK_TEMPLATE(BM_BranchSearch, succinct::trie::search_sorted_branches)->Apply(widths);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,238 @@
+//
+// Construction benchmark: times every phase of building a trie and prints JSON.
+//
+//     bench_construction [count] [lex|centroid|both]
+//
+// Keys come from the same environment variables as the other benchmarks
+// (PDT_BENCH_KEYS_FILE, PDT_BENCH_DATASET, PDT_BENCH_SEED), `count` defaults
+// to PDT_BENCH_MAX_KEYS (1M).
+//
+// Phases:
+//   - append:      compacted_trie_builder::append of every key
+//   - finish:      compacted_trie_builder::finish
+//   - construct:   DefaultPathDecomposedTrie constructor (BP index + word_positions)
+//   - serialize:   copy of the raw vectors into one buffer
+//   - deserialize: the decoding constructor on that buffer (rank/select + BP index rebuilt)
+//
+// Each decomposition runs in a forked child, so that its peak RSS (getrusage
+// ru_maxrss) starts from the RSS of the generated keys and not from the peak
+// of the previous run.
+//
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "bench_util.h"
+
+namespace {
+    typedef std::chrono::steady_clock clock_type;
+
+    // peak resident set size of the process so far, in bytes
+    uint64_t peak_rss() {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+    }
+
+    std::string json_escape(const std::string& s) {
+        std::string res;
+        for (char c : s) {
+            if (c == '"' || c == '\\') res += '\\';
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                res += buf;
+                continue;
+            }
+            res += c;
+        }
+        return res;
+    }
+
+    struct Phase {
+        const char* name;
+        double seconds;
+        uint64_t peak_rss;
+    };
+
+    class PhaseTimer {
+    public:
+        explicit PhaseTimer(std::vector<Phase>& phases) : m_phases(phases) {}
+
+        template <typename Fn>
+        void run(const char* name, Fn fn) {
+            auto start = clock_type::now();
+            fn();
+            auto end = clock_type::now();
+            m_phases.push_back({name, std::chrono::duration<double>(end - start).count(), peak_rss()});
+        }
+
+    private:
+        std::vector<Phase>& m_phases;
+    };
+
+    template <typename T>
+    void put(std::string& buf, const T* data, uint64_t n) {
+        buf.append(reinterpret_cast<const char*>(&n), sizeof(n));
+        buf.append(reinterpret_cast<const char*>(data), n * sizeof(T));
+    }
+
+    template <typename T>
+    const T* get(const char*& p, uint64_t& n) {
+        memcpy(&n, p, sizeof(n));
+        p += sizeof(n);
+        const T* data = reinterpret_cast<const T*>(p);
+        p += n * sizeof(T);
+        return data;
+    }
+
+    template <bool Lexicographic>
+    void run(const std::vector<std::string>& keys) {
+        typedef succinct::DefaultTreeBuilder<Lexicographic> tree_builder_t;
+        typedef succinct::trie::DefaultPathDecomposedTrie<Lexicographic> trie_t;
+
+        // converted up front, the conversion is not part of `append`
+        std::vector<std::vector<uint8_t>> bytes;
+        bytes.reserve(keys.size());
+        for (auto& key : keys) bytes.emplace_back(key.begin(), key.end());
+        uint64_t rss_before = peak_rss();
+
+        std::vector<Phase> phases;
+        PhaseTimer timer(phases);
+        tree_builder_t pdt_builder;
+        succinct::trie::compacted_trie_builder<tree_builder_t> trieBuilder(pdt_builder);
+        std::unique_ptr<trie_t> trie, decoded;
+        std::string buffer;
+
+        timer.run("append", [&] {
+            for (auto& b : bytes) trieBuilder.append(b);
+        });
+        timer.run("finish", [&] {
+            trieBuilder.finish();
+        });
+        timer.run("construct", [&] {
+            trie.reset(new trie_t(trieBuilder));
+        });
+        timer.run("serialize", [&] {
+            const auto& bp = trie->get_bp();
+            buffer.reserve(4 * sizeof(uint64_t) + trie->get_labels().size() * sizeof(uint16_t) +
+                           trie->get_branches().size() * sizeof(uint16_t) +
+                           bp.data().size() * sizeof(uint64_t) +
+                           trie->word_positions.size() * sizeof(uint64_t) + sizeof(uint64_t));
+            put(buffer, trie->get_labels().data(), trie->get_labels().size());
+            put(buffer, trie->get_branches().data(), trie->get_branches().size());
+            uint64_t bit_size = bp.size();
+            buffer.append(reinterpret_cast<const char*>(&bit_size), sizeof(bit_size));
+            put(buffer, bp.data().data(), bp.data().size());
+            put(buffer, trie->word_positions.data(), trie->word_positions.size());
+        });
+        timer.run("deserialize", [&] {
+            const char* p = buffer.data();
+            uint64_t label_len, branch_len, bit_size, word_size, pos_len;
+            const uint16_t* labels = get<uint16_t>(p, label_len);
+            const uint16_t* branches = get<uint16_t>(p, branch_len);
+            memcpy(&bit_size, p, sizeof(bit_size));
+            p += sizeof(bit_size);
+            const uint64_t* words = get<uint64_t>(p, word_size);
+            const uint64_t* positions = get<uint64_t>(p, pos_len);
+            decoded.reset(new trie_t(labels, label_len, branches, branch_len,
+                                     words, word_size, bit_size, positions, pos_len));
+        });
+
+        // sanity check, a broken decoder would make the numbers meaningless
+        for (size_t i = 0; i < keys.size(); i += 1 + keys.size() / 64) {
+            if (decoded->index(keys[i]) != trie->index(keys[i])) {
+                fprintf(stderr, "deserialized trie differs from the built one\n");
+                exit(1);
+            }
+        }
+
+        double n = keys.size();
+        succinct::SpaceReport space = trie->space_report();
+        succinct::SpaceReport decoded_space = decoded->space_report();
+
+        printf("    {\n");
+        printf("      \"decomposition\": \"%s\",\n", Lexicographic ? "lex" : "centroid");
+        printf("      \"peak_rss_before\": %llu,\n", (unsigned long long)rss_before);
+        printf("      \"phases\": [\n");
+        for (size_t i = 0; i < phases.size(); ++i) {
+            printf("        {\"name\": \"%s\", \"seconds\": %.6f, \"keys_per_second\": %.1f, \"peak_rss\": %llu}%s\n",
+                   phases[i].name, phases[i].seconds,
+                   phases[i].seconds > 0 ? n / phases[i].seconds : 0.0,
+                   (unsigned long long)phases[i].peak_rss, i + 1 < phases.size() ? "," : "");
+        }
+        printf("      ],\n");
+        printf("      \"bytes_per_key\": {\n");
+        for (auto& c : space.components) {
+            printf("        \"%s\": %.3f,\n", c.name.c_str(), c.bytes / n);
+        }
+        printf("        \"total\": %.3f\n", space.total_bytes() / n);
+        printf("      },\n");
+        printf("      \"total_bytes\": %llu,\n", (unsigned long long)space.total_bytes());
+        printf("      \"serialized_bytes\": %llu,\n", (unsigned long long)buffer.size());
+        // the decoded trie maps the serialized arrays and owns the rebuilt directories
+        printf("      \"deserialized_owned_bytes\": %llu,\n", (unsigned long long)decoded_space.owned_bytes());
+        printf("      \"deserialized_mapped_bytes\": %llu\n", (unsigned long long)decoded_space.mapped_bytes());
+        printf("    }");
+        fflush(stdout);
+    }
+
+    // run `fn` in a child process and wait for it
+    template <typename Fn>
+    bool run_forked(Fn fn) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid < 0) return false;
+        if (pid == 0) {
+            fn();
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                            : bench::env_uint("PDT_BENCH_MAX_KEYS", 1000000);
+    std::string which = argc > 2 ? argv[2] : "both";
+    if (!count || (which != "lex" && which != "centroid" && which != "both")) {
+        fprintf(stderr, "usage: %s [count] [lex|centroid|both]\n", argv[0]);
+        return 1;
+    }
+
+    const auto& keys = bench::get_keys(count);
+    bench::KeyStats stats = bench::key_stats(keys);
+    const char* file = std::getenv("PDT_BENCH_KEYS_FILE");
+    const char* dataset = std::getenv("PDT_BENCH_DATASET");
+
+    printf("{\n");
+    printf("  \"keys\": %llu,\n", (unsigned long long)stats.count);
+    if (file && *file) {
+        printf("  \"keys_file\": \"%s\",\n", json_escape(file).c_str());
+    } else {
+        printf("  \"dataset\": \"%s\",\n", json_escape(dataset && *dataset ? dataset : "words").c_str());
+        printf("  \"seed\": %llu,\n", (unsigned long long)bench::env_uint("PDT_BENCH_SEED", 42));
+    }
+    printf("  \"avg_key_length\": %.3f,\n", stats.avg_length);
+    printf("  \"avg_lcp\": %.3f,\n", stats.avg_lcp);
+    printf("  \"runs\": [\n");
+    bool ok = true, first = true;
+    if (which != "centroid") {
+        ok &= run_forked([&] { run<true>(keys); });
+        first = false;
+    }
+    if (which != "lex") {
+        if (!first) printf(",\n");
+        ok &= run_forked([&] { run<false>(keys); });
+    }
+    printf("\n  ]\n");
+    printf("}\n");
+    return ok ? 0 : 1;
+}
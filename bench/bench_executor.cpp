@@ -0,0 +1,67 @@
+//
+// Scaling of QueryExecutor: `index_all()` (`index_sorted_batch()` per chunk)
+// of 1M random queries from 1 thread up to PDT_BENCH_MAX_THREADS (default
+// the hardware threads), over PDT_BENCH_EXECUTOR_KEYS keys (default 1M).
+//
+// `padded:1` writes every result on its own cache line: if the dense output
+// (`padded:0`) scales worse, the threads are false sharing its lines, which
+// small chunks (`chunk:16`, 64 bytes of results) make visible.
+//
+
+#include "bench_util.h"
+#include "query_executor.h"
+
+static const size_t N_QUERIES = 1 << 20;
+// ints between two padded results, no two of them share a cache line
+static const size_t PADDING = 64 / sizeof(int);
+
+static void BM_IndexAll(benchmark::State& state) {
+    size_t n_threads = state.range(0);
+    size_t chunk_size = state.range(1);
+    bool padded = state.range(2);
+    size_t n = bench::env_uint("PDT_BENCH_EXECUTOR_KEYS", 1000000);
+    const auto& keys = bench::get_keys(n);
+    const auto& trie = bench::get_trie<false>(n);
+    auto positions = bench::random_positions(N_QUERIES, keys.size());
+    std::vector<std::string> queries;
+    queries.reserve(N_QUERIES);
+    for (auto p : positions) queries.push_back(keys[p]);
+
+    succinct::trie::QueryExecutor executor(n_threads);
+    std::vector<int> out(N_QUERIES);
+    std::vector<int> padded_out(padded ? N_QUERIES * PADDING : 0);
+    for (auto _ : state) {
+        if (padded) {
+            // the kernel of index_all(), then the results spread out
+            executor.parallel_for(N_QUERIES, chunk_size, [&](size_t begin, size_t end) {
+                thread_local std::vector<int> ids;
+                ids.resize(end - begin);
+                trie.index_sorted_batch(queries.data() + begin, end - begin, ids.data());
+                for (size_t i = begin; i < end; ++i) padded_out[i * PADDING] = ids[i - begin];
+            });
+        } else {
+            succinct::trie::index_all(executor, trie, queries.data(), N_QUERIES, out.data(), chunk_size);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * N_QUERIES);
+}
+
+static void thread_counts(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"threads", "chunk", "padded"});
+    b->UseRealTime();
+    b->Unit(benchmark::kMillisecond);
+    uint64_t max_threads = bench::env_uint("PDT_BENCH_MAX_THREADS",
+                                           std::max(1u, std::thread::hardware_concurrency()));
+    for (uint64_t t = 1; ; t = std::min(t * 2, max_threads)) {
+        for (int64_t chunk : {16, 4096}) {
+            b->Args({static_cast<int64_t>(t), chunk, 0});
+            b->Args({static_cast<int64_t>(t), chunk, 1});
+        }
+        if (t == max_threads) break;
+    }
+}
+
+BENCHMARK(BM_IndexAll)->Apply(thread_counts);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,63 @@
+//
+// rank/select benchmarks of RsBitVector.
+//
+
+#include "bench_util.h"
+#include "rank_select_bit_vector.h"
+
+static const size_t N_QUERIES = 1 << 16;
+
+// random bits with 1/2 density, select hints enabled as in the trie
+static const succinct::RsBitVector& get_bit_vector(size_t n) {
+    static std::map<size_t, std::unique_ptr<succinct::RsBitVector>> cache;
+    auto it = cache.find(n);
+    if (it == cache.end()) {
+        std::mt19937_64 rng(n);
+        succinct::BitVectorBuilder builder;
+        builder.reserve(n);
+        for (size_t i = 0; i < n; i += 64) {
+            size_t len = std::min<size_t>(64, n - i);
+            uint64_t bits = rng();
+            builder.append_bits(len == 64 ? bits : bits & ((1ULL << len) - 1), len);
+        }
+        it = cache.emplace(n, std::unique_ptr<succinct::RsBitVector>(
+                new succinct::RsBitVector(&builder, true, true))).first;
+    }
+    return *it->second;
+}
+
+static void BM_Rank(benchmark::State& state) {
+    const auto& bv = get_bit_vector(state.range(0));
+    auto queries = bench::random_positions(N_QUERIES, bv.size());
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(bv.rank(queries[i % N_QUERIES]));
+    });
+}
+
+static void BM_Select(benchmark::State& state) {
+    const auto& bv = get_bit_vector(state.range(0));
+    auto queries = bench::random_positions(N_QUERIES, bv.num_ones());
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(bv.select(queries[i % N_QUERIES]));
+    });
+}
+
+static void BM_Select0(benchmark::State& state) {
+    const auto& bv = get_bit_vector(state.range(0));
+    auto queries = bench::random_positions(N_QUERIES, bv.num_zeros());
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(bv.select0(queries[i % N_QUERIES]));
+    });
+}
+
+BENCHMARK(BM_Rank)->Apply(bench::bit_sizes);
+BENCHMARK(BM_Rank)->Apply(bench::cold_bit_sizes);
+BENCHMARK(BM_Select)->Apply(bench::bit_sizes);
+BENCHMARK(BM_Select)->Apply(bench::cold_bit_sizes);
+BENCHMARK(BM_Select0)->Apply(bench::bit_sizes);
+BENCHMARK(BM_Select0)->Apply(bench::cold_bit_sizes);
+
+BENCHMARK_MAIN();
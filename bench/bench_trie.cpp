@@ -0,0 +1,343 @@
+//
+// Lookup benchmarks of DefaultPathDecomposedTrie: `index()` and `operator[]`,
+// and `index()` with the navigation index (`nav_bytes_per_key` is its size)
+// or the top-level table of `PDT_BENCH_TOP_LEVEL_BYTES` (default 1MiB, the
+// 2-byte table; `top_level_bytes_per_key` is its size). `BM_IndexSkewed`
+// draws the keys from a Zipf distribution, with or without a HotKeyCache of
+// `PDT_BENCH_CACHE_BYTES` (default 1MiB) in front (`hit_rate`).
+// `BM_IndexWeighted` runs the same queries on the centroid trie and on the
+// one weighted by a Zipf query log of another seed, with the expected nodes
+// visited per query (`expected_nodes_per_query`, 1 + light edges).
+// `BM_IndexSorted` looks up sorted batches of 256 keys, one by one or with
+// `index_sorted_batch()`. `BM_Rank` is `rank()` (`rank_bits_per_key`, the
+// centroid one stores the ranks as a Permutation), `BM_LowerBound` is
+// `lower_bound()` of the keys without their last byte and `BM_Select` is
+// `select()` of random ranks, through the sampled inverse for the centroid
+// one. `BM_IndexEncoded` / `BM_AccessEncoded` run
+// on each LabelEncoding, with the label and tail pool bytes per key.
+// `BM_IndexKeyEncoded` / `BM_AccessKeyEncoded` compare
+// the trie of the raw keys with the one of the keys through a KeyEncoder
+// (`bytes_per_key`, `bp_bits_per_key`).
+//
+
+#include "bench_util.h"
+#include "hot_key_cache.h"
+
+static const size_t N_QUERIES = 1 << 16;
+
+template <bool Lexicographic>
+static void BM_Index(benchmark::State& state) {
+    size_t n = state.range(0);
+    const auto& keys = bench::get_keys(n);
+    const auto& trie = bench::get_trie<Lexicographic>(n);
+    auto queries = bench::random_positions(N_QUERIES, keys.size());
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(trie.index(keys[queries[i % N_QUERIES]]));
+    });
+}
+
+template <bool Lexicographic>
+static void BM_IndexNavigation(benchmark::State& state) {
+    size_t n = state.range(0);
+    const auto& keys = bench::get_keys(n);
+    const auto& trie = bench::get_navigation_trie<Lexicographic>(n);
+    auto queries = bench::random_positions(N_QUERIES, keys.size());
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(trie.index(keys[queries[i % N_QUERIES]]));
+    });
+    state.counters["nav_bytes_per_key"] =
+            double(trie.m_nav.space_report().total_bytes()) / double(keys.size());
+}
+
+template <bool Lexicographic>
+static void BM_Rank(benchmark::State& state) {
+    size_t n = state.range(0);
+    const auto& keys = bench::get_keys(n);
+    const auto& trie = bench::get_rank_trie<Lexicographic>(n);
+    auto queries = bench::random_positions(N_QUERIES, keys.size());
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(trie.rank(keys[queries[i % N_QUERIES]]));
+    });
+    state.counters["rank_bits_per_key"] =
+            double(8 * trie.m_ranks.space_report().total_bytes()) / double(keys.size());
+}
+
+template <bool Lexicographic>
+static void BM_LowerBound(benchmark::State& state) {
+    size_t n = state.range(0);
+    const auto& keys = bench::get_keys(n);
+    const auto& trie = bench::get_rank_trie<Lexicographic>(n);
+    auto positions = bench::random_positions(N_QUERIES, keys.size());
+    std::vector<std::string> queries;
+    for (auto p : positions) queries.push_back(keys[p].substr(0, keys[p].size() - 1));
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(trie.lower_bound(queries[i % N_QUERIES]));
+    });
+}
+
+template <bool Lexicographic>
+static void BM_Select(benchmark::State& state) {
+    size_t n = state.range(0);
+    const auto& keys = bench::get_keys(n);
+    const auto& trie = bench::get_rank_trie<Lexicographic>(n);
+    auto queries = bench::random_positions(N_QUERIES, keys.size());
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(trie.select(queries[i % N_QUERIES]));
+    });
+}
+
+template <bool Lexicographic>
+static void BM_IndexTopLevel(benchmark::State& state) {
+    size_t n = state.range(0);
+    const auto& keys = bench::get_keys(n);
+    const auto& trie = bench::get_top_level_trie<Lexicographic>(
+            n, bench::env_uint("PDT_BENCH_TOP_LEVEL_BYTES", 1 << 20));
+    auto queries = bench::random_positions(N_QUERIES, keys.size());
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(trie.index(keys[queries[i % N_QUERIES]]));
+    });
+    state.counters["top_level_bytes_per_key"] =
+            double(trie.m_top.space_report().total_bytes()) / double(keys.size());
+}
+
+template <bool Lexicographic, bool Cached>
+static void BM_IndexSkewed(benchmark::State& state) {
+    size_t n = state.range(0);
+    const auto& keys = bench::get_keys(n);
+    const auto& trie = bench::get_trie<Lexicographic>(n);
+    auto queries = bench::zipf_positions(N_QUERIES, keys.size());
+    succinct::trie::HotKeyCache<succinct::trie::DefaultPathDecomposedTrie<Lexicographic>>
+            cache(trie, bench::env_uint("PDT_BENCH_CACHE_BYTES", 1 << 20));
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        const std::string& key = keys[queries[i % N_QUERIES]];
+        benchmark::DoNotOptimize(Cached ? cache.index(key) : trie.index(key));
+    });
+    if (Cached) {
+        auto stats = cache.stats();
+        state.counters["hit_rate"] = double(stats.hits) / double(stats.hits + stats.misses);
+    }
+}
+
+template <bool Weighted>
+static void BM_IndexWeighted(benchmark::State& state) {
+    size_t n = state.range(0);
+    const auto& keys = bench::get_keys(n);
+    const auto& trie = Weighted ? bench::get_weighted_trie(n) : bench::get_trie<false>(n);
+    auto queries = bench::zipf_positions(N_QUERIES, keys.size());
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(trie.index(keys[queries[i % N_QUERIES]]));
+    });
+    uint64_t nodes = 0;
+    for (auto q : queries) {
+        size_t node = size_t(trie.index(keys[q])), branch_no;
+        uint16_t branch;
+        ++nodes;
+        while (trie.get_parent_node_branch_by_node_idx(node, node, branch, branch_no)) ++nodes;
+    }
+    state.counters["expected_nodes_per_query"] = double(nodes) / double(queries.size());
+}
+
+template <bool Lexicographic, bool Batched>
+static void BM_IndexSorted(benchmark::State& state) {
+    static const size_t BATCH = 256;
+    size_t n = state.range(0);
+    const auto& keys = bench::get_keys(n);
+    const auto& trie = bench::get_trie<Lexicographic>(n);
+    auto queries = bench::random_positions(N_QUERIES, keys.size());
+    std::vector<std::string> sorted;
+    for (auto q : queries) sorted.push_back(keys[q]);
+    for (size_t i = 0; i < N_QUERIES; i += BATCH) {
+        std::sort(sorted.begin() + i, sorted.begin() + i + BATCH);
+    }
+    std::vector<int> out(BATCH);
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        const std::string* batch = sorted.data() + (i * BATCH) % N_QUERIES;
+        if (Batched) {
+            trie.index_sorted_batch(batch, BATCH, out.data());
+        } else {
+            for (size_t j = 0; j < BATCH; ++j) out[j] = trie.index(batch[j]);
+        }
+        benchmark::DoNotOptimize(out.data());
+    });
+    state.SetItemsProcessed(state.iterations() * BATCH);
+}
+
+// bytes per key of the labels (raw, Re-Pair) and of the tail pool
+template <typename Trie>
+static void set_label_bytes(benchmark::State& state, const Trie& trie, size_t n_keys) {
+    succinct::SpaceReport report = trie.space_report();
+    uint64_t label_bytes = report.bytes("labels");
+    uint64_t tail_bytes = 0;
+    for (auto& c : report.components) {
+        if (c.name.compare(0, 14, "repair_labels.") == 0) label_bytes += c.bytes;
+        if (c.name.compare(0, 6, "tails.") == 0) tail_bytes += c.bytes;
+    }
+    state.counters["label_bytes_per_key"] = double(label_bytes) / double(n_keys);
+    state.counters["tail_bytes_per_key"] = double(tail_bytes) / double(n_keys);
+}
+
+template <bool Lexicographic, succinct::trie::LabelEncoding Encoding>
+static void BM_IndexEncoded(benchmark::State& state) {
+    size_t n = state.range(0);
+    const auto& keys = bench::get_keys(n);
+    const auto& trie = bench::get_encoded_trie<Lexicographic>(n, Encoding);
+    auto queries = bench::random_positions(N_QUERIES, keys.size());
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(trie.index(keys[queries[i % N_QUERIES]]));
+    });
+    set_label_bytes(state, trie, keys.size());
+}
+
+template <bool Lexicographic, succinct::trie::LabelEncoding Encoding>
+static void BM_AccessEncoded(benchmark::State& state) {
+    size_t n = state.range(0);
+    const auto& keys = bench::get_keys(n);
+    const auto& trie = bench::get_encoded_trie<Lexicographic>(n, Encoding);
+    auto queries = bench::random_positions(N_QUERIES, keys.size());
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(trie[queries[i % N_QUERIES]]);
+    });
+    set_label_bytes(state, trie, keys.size());
+}
+
+template <bool Lexicographic, bool Encoded>
+static const succinct::trie::DefaultPathDecomposedTrie<Lexicographic>& key_encoded_trie(size_t n) {
+    return Encoded ? bench::get_key_encoded_trie<Lexicographic>(n) : bench::get_trie<Lexicographic>(n);
+}
+
+template <typename Trie>
+static void set_trie_bytes(benchmark::State& state, const Trie& trie, size_t n_keys) {
+    set_label_bytes(state, trie, n_keys);
+    state.counters["bytes_per_key"] = double(trie.space_report().total_bytes()) / double(n_keys);
+    state.counters["bp_bits_per_key"] = double(trie.get_bp().size()) / double(n_keys);
+}
+
+template <bool Lexicographic, bool Encoded>
+static void BM_IndexKeyEncoded(benchmark::State& state) {
+    size_t n = state.range(0);
+    const auto& keys = bench::get_keys(n);
+    const auto& trie = key_encoded_trie<Lexicographic, Encoded>(n);
+    auto queries = bench::random_positions(N_QUERIES, keys.size());
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(trie.index(keys[queries[i % N_QUERIES]]));
+    });
+    set_trie_bytes(state, trie, keys.size());
+}
+
+template <bool Lexicographic, bool Encoded>
+static void BM_AccessKeyEncoded(benchmark::State& state) {
+    size_t n = state.range(0);
+    const auto& keys = bench::get_keys(n);
+    const auto& trie = key_encoded_trie<Lexicographic, Encoded>(n);
+    auto queries = bench::random_positions(N_QUERIES, keys.size());
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(trie[queries[i % N_QUERIES]]);
+    });
+    set_trie_bytes(state, trie, keys.size());
+}
+
+template <bool Lexicographic>
+static void BM_IndexMiss(benchmark::State& state) {
+    size_t n = state.range(0);
+    const auto& keys = bench::get_keys(n);
+    const auto& trie = bench::get_trie<Lexicographic>(n);
+    auto queries = bench::random_positions(N_QUERIES, keys.size());
+    std::vector<std::string> missing;
+    missing.reserve(N_QUERIES);
+    for (auto q : queries) {
+        // absent key that shares the whole path of an existing one
+        missing.push_back(keys[q] + "~");
+    }
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(trie.index(missing[i % N_QUERIES]));
+    });
+}
+
+template <bool Lexicographic>
+static void BM_Access(benchmark::State& state) {
+    size_t n = state.range(0);
+    const auto& keys = bench::get_keys(n);
+    const auto& trie = bench::get_trie<Lexicographic>(n);
+    auto queries = bench::random_positions(N_QUERIES, keys.size());
+
+    bench::run_ops(state, state.range(1), [&](size_t i) {
+        benchmark::DoNotOptimize(trie[queries[i % N_QUERIES]]);
+    });
+}
+
+BENCHMARK_TEMPLATE(BM_Index, false)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_Index, false)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_Index, true)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_Index, true)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexNavigation, false)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexNavigation, false)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexNavigation, true)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexNavigation, true)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_Rank, false)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_Rank, true)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_LowerBound, false)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_LowerBound, true)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_Select, false)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_Select, true)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexTopLevel, false)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexTopLevel, false)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexTopLevel, true)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexTopLevel, true)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexSkewed, false, false)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexSkewed, false, false)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexSkewed, false, true)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexSkewed, false, true)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexWeighted, false)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexWeighted, false)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexWeighted, true)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexWeighted, true)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexSorted, false, false)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexSorted, false, false)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexSorted, false, true)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexSorted, false, true)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexEncoded, false, succinct::trie::LabelEncoding::RAW)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexEncoded, false, succinct::trie::LabelEncoding::RAW)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_AccessEncoded, false, succinct::trie::LabelEncoding::RAW)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_AccessEncoded, false, succinct::trie::LabelEncoding::RAW)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexEncoded, false, succinct::trie::LabelEncoding::REPAIR)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexEncoded, false, succinct::trie::LabelEncoding::REPAIR)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_AccessEncoded, false, succinct::trie::LabelEncoding::REPAIR)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_AccessEncoded, false, succinct::trie::LabelEncoding::REPAIR)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexEncoded, false, succinct::trie::LabelEncoding::TAIL)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexEncoded, false, succinct::trie::LabelEncoding::TAIL)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_AccessEncoded, false, succinct::trie::LabelEncoding::TAIL)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_AccessEncoded, false, succinct::trie::LabelEncoding::TAIL)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexEncoded, false, succinct::trie::LabelEncoding::TAIL_REPAIR)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexEncoded, false, succinct::trie::LabelEncoding::TAIL_REPAIR)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_AccessEncoded, false, succinct::trie::LabelEncoding::TAIL_REPAIR)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_AccessEncoded, false, succinct::trie::LabelEncoding::TAIL_REPAIR)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexKeyEncoded, false, false)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexKeyEncoded, false, false)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_AccessKeyEncoded, false, false)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexKeyEncoded, false, true)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexKeyEncoded, false, true)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_AccessKeyEncoded, false, true)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexMiss, false)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexMiss, false)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexMiss, true)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_IndexMiss, true)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_Access, false)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_Access, false)->Apply(bench::cold_key_sizes);
+BENCHMARK_TEMPLATE(BM_Access, true)->Apply(bench::key_sizes);
+BENCHMARK_TEMPLATE(BM_Access, true)->Apply(bench::cold_key_sizes);
+
+BENCHMARK_MAIN();
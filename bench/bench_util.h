@@ -0,0 +1,288 @@
+//
+// Shared helpers of the micro benchmarks in bench/.
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_BENCH_UTIL_H
+#define PATH_DECOMPOSITION_TRIE_BENCH_UTIL_H
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "path_decomposed_trie.h"
+#include "key_dataset.h"
+
+namespace bench {
+    // Read a positive integer from environment variable `name`,
+    // `def` is returned if it is not set.
+    inline uint64_t env_uint(const char* name, uint64_t def) {
+        const char* v = std::getenv(name);
+        if (!v || !*v) return def;
+        return std::strtoull(v, nullptr, 10);
+    }
+
+    // Register decimal sizes [min, max] (x10 each step) as the first argument
+    // and cold-cache mode (0/1) as the second one.
+    // `max` can be lowered/raised by `env_name`, e.g. PDT_BENCH_MAX_KEYS=100000000.
+    // Cold runs use a fixed number of iterations (PDT_BENCH_COLD_ITERS), since
+    // the untimed cache flushes would otherwise make the time-based runs endless,
+    // and they are timed manually around the single operation.
+    inline void register_sizes(benchmark::internal::Benchmark* b, uint64_t min, uint64_t max,
+                               const char* env_name, bool cold) {
+        max = env_uint(env_name, max);
+        if (cold) {
+            b->Iterations(static_cast<int64_t>(env_uint("PDT_BENCH_COLD_ITERS", 200)));
+            b->UseManualTime();
+        }
+        for (uint64_t n = min; n <= max; n *= 10) {
+            b->Args({static_cast<int64_t>(n), cold});
+        }
+    }
+
+    inline void key_sizes(benchmark::internal::Benchmark* b) {
+        b->ArgNames({"keys", "cold"});
+        register_sizes(b, 1000, 1000000, "PDT_BENCH_MAX_KEYS", false);
+    }
+
+    inline void cold_key_sizes(benchmark::internal::Benchmark* b) {
+        b->ArgNames({"keys", "cold"});
+        register_sizes(b, 1000, 1000000, "PDT_BENCH_MAX_KEYS", true);
+    }
+
+    inline void bit_sizes(benchmark::internal::Benchmark* b) {
+        b->ArgNames({"bits", "cold"});
+        register_sizes(b, 1000, 100000000, "PDT_BENCH_MAX_BITS", false);
+    }
+
+    inline void cold_bit_sizes(benchmark::internal::Benchmark* b) {
+        b->ArgNames({"bits", "cold"});
+        register_sizes(b, 1000, 100000000, "PDT_BENCH_MAX_BITS", true);
+    }
+
+    // Evict the caches by touching a buffer that is much larger than the LLC.
+    // The size is PDT_BENCH_COLD_BYTES (64MiB by default).
+    inline void flush_cache() {
+        static std::vector<uint64_t> buffer(env_uint("PDT_BENCH_COLD_BYTES", 64ULL << 20) / sizeof(uint64_t), 1);
+        uint64_t sum = 0;
+        for (size_t i = 0; i < buffer.size(); i += 8) {
+            buffer[i] += sum;
+            sum += buffer[i];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    // Run `op` once per iteration. In cold-cache mode the caches are flushed
+    // before every operation and only the operation itself is timed.
+    // With PDT_ENABLE_COUNTERS every non zero hot-path counter is reported per operation.
+    template <typename Op>
+    inline void run_ops(benchmark::State& state, bool cold, Op op) {
+        size_t i = 0;
+#ifdef PDT_ENABLE_COUNTERS
+        succinct::counters::reset();
+#endif
+        if (!cold) {
+            for (auto _ : state) {
+                op(i++);
+            }
+        } else {
+            for (auto _ : state) {
+                flush_cache();
+                auto start = std::chrono::steady_clock::now();
+                op(i++);
+                auto end = std::chrono::steady_clock::now();
+                state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+#ifdef PDT_ENABLE_COUNTERS
+        auto counters = succinct::counters::snapshot();
+        for (size_t c = 0; c < succinct::counters::N_COUNTERS; ++c) {
+            if (counters.values[c]) {
+                state.counters[succinct::counters::counter_name(succinct::counters::counter_id(c))] =
+                        benchmark::Counter(double(counters.values[c]), benchmark::Counter::kAvgIterations);
+            }
+        }
+#endif
+    }
+
+    // `n` random positions in [0, range), the access pattern of the benchmarks.
+    inline std::vector<uint64_t> random_positions(size_t n, uint64_t range, uint64_t seed = 42) {
+        std::mt19937_64 rng(seed);
+        std::vector<uint64_t> pos(n);
+        for (auto& p : pos) p = rng() % range;
+        return pos;
+    }
+
+    // `n` positions in [0, range) drawn from a Zipf distribution of exponent
+    // `s`, the ranks scattered over the range
+    inline std::vector<uint64_t> zipf_positions(size_t n, uint64_t range, double s = 1.0, uint64_t seed = 42) {
+        std::vector<double> cdf(range);
+        double sum = 0;
+        for (uint64_t r = 0; r < range; ++r) {
+            sum += 1.0 / std::pow(double(r + 1), s);
+            cdf[r] = sum;
+        }
+        std::mt19937_64 rng(seed);
+        std::uniform_real_distribution<double> dist(0, sum);
+        std::vector<uint64_t> pos(n);
+        for (auto& p : pos) {
+            uint64_t r = std::lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin();
+            p = (std::min(r, range - 1) * 0x9E3779B97F4A7C15ULL) % range;
+        }
+        return pos;
+    }
+
+    // The key set of `n` keys of the benchmarks:
+    //   - PDT_BENCH_KEYS_FILE=<file written by gen_keys>: `n` evenly spaced keys of the file,
+    //   - otherwise PDT_BENCH_DATASET=<distribution> (default "words") generated
+    //     with seed PDT_BENCH_SEED (default 42).
+    // Keys and tries are built once per size and shared by all benchmarks of a process.
+    inline const std::vector<std::string>& get_keys(size_t n) {
+        static std::map<size_t, std::vector<std::string>> cache;
+        auto it = cache.find(n);
+        if (it == cache.end()) {
+            std::vector<std::string> keys;
+            const char* file = std::getenv("PDT_BENCH_KEYS_FILE");
+            if (file && *file) {
+                static std::vector<std::string> all = read_key_file(file);
+                if (n >= all.size()) {
+                    keys = all;
+                } else {
+                    for (size_t i = 0; i < n; ++i) keys.push_back(all[i * all.size() / n]);
+                }
+            } else {
+                const char* dataset = std::getenv("PDT_BENCH_DATASET");
+                KeyGenerator generator(env_uint("PDT_BENCH_SEED", 42));
+                keys = generator.generate(dataset && *dataset ? dataset : "words", n);
+            }
+            it = cache.emplace(n, std::move(keys)).first;
+        }
+        return it->second;
+    }
+
+    // What the tree builder is given besides the keys.
+    struct BuildOptions {
+        const succinct::trie::KeyEncoder* key_encoder = nullptr;   // compacted_trie_builder(builder, encoder)
+        const std::vector<uint64_t>* weights = nullptr;             // per key, DefaultTreeBuilder::set_weighted()
+    };
+
+    // `TrieType(builder, args...)` over `keys`
+    template <bool Lexicographic,
+              typename TrieType = succinct::trie::DefaultPathDecomposedTrie<Lexicographic>,
+              typename... Args>
+    std::unique_ptr<TrieType> build_trie(const std::vector<std::string>& keys,
+                                         const BuildOptions& options, Args... args) {
+        succinct::DefaultTreeBuilder<Lexicographic> pdt_builder;
+        if (options.weights) pdt_builder.set_weighted(true);
+        succinct::trie::compacted_trie_builder
+                <succinct::DefaultTreeBuilder<Lexicographic>>
+                trieBuilder(pdt_builder, options.key_encoder);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            std::vector<uint8_t> bytes(keys[i].begin(), keys[i].end());
+            trieBuilder.append(bytes, options.weights ? (*options.weights)[i] : 1);
+        }
+        trieBuilder.finish();
+        return std::unique_ptr<TrieType>(new TrieType(trieBuilder, args...));
+    }
+
+    // The trie built by `build(get_keys(n))` once per (`n`, `variant`) and
+    // shared by the benchmarks of a process. Every getter below passes its
+    // own lambda, hence has its own cache.
+    template <typename Build>
+    auto cached_trie(size_t n, uint64_t variant, Build build) -> decltype(*build(get_keys(n))) {
+        typedef typename std::remove_reference<decltype(*build(get_keys(n)))>::type trie_t;
+        static std::map<std::pair<size_t, uint64_t>, std::unique_ptr<trie_t>> cache;
+        auto key = std::make_pair(n, variant);
+        auto it = cache.find(key);
+        if (it == cache.end()) {
+            it = cache.emplace(key, build(get_keys(n))).first;
+        }
+        return *it->second;
+    }
+
+    template <bool Lexicographic>
+    const succinct::trie::DefaultPathDecomposedTrie<Lexicographic>& get_trie(size_t n) {
+        return cached_trie(n, 0, [](const std::vector<std::string>& keys) {
+            return build_trie<Lexicographic>(keys, BuildOptions());
+        });
+    }
+
+    // the trie of get_trie() with build_navigation_index()
+    template <bool Lexicographic>
+    const succinct::trie::DefaultPathDecomposedTrie<Lexicographic>& get_navigation_trie(size_t n) {
+        return cached_trie(n, 0, [](const std::vector<std::string>& keys) {
+            auto trie = build_trie<Lexicographic>(keys, BuildOptions());
+            trie->build_navigation_index();
+            return trie;
+        });
+    }
+
+    // the trie of get_trie() with build_rank_index()
+    template <bool Lexicographic>
+    const succinct::trie::DefaultPathDecomposedTrie<Lexicographic>& get_rank_trie(size_t n) {
+        return cached_trie(n, 0, [](const std::vector<std::string>& keys) {
+            auto trie = build_trie<Lexicographic>(keys, BuildOptions());
+            trie->build_rank_index();
+            return trie;
+        });
+    }
+
+    // the trie of get_trie() with the labels stored as `encoding`
+    template <bool Lexicographic>
+    const succinct::trie::DefaultPathDecomposedTrie<Lexicographic>& get_encoded_trie(
+            size_t n, succinct::trie::LabelEncoding encoding) {
+        return cached_trie(n, uint64_t(encoding), [encoding](const std::vector<std::string>& keys) {
+            return build_trie<Lexicographic>(keys, BuildOptions(), encoding);
+        });
+    }
+
+    // the keys of get_trie() through a KeyEncoder of 10K of them
+    template <bool Lexicographic>
+    const succinct::trie::DefaultPathDecomposedTrie<Lexicographic>& get_key_encoded_trie(size_t n) {
+        return cached_trie(n, 0, [](const std::vector<std::string>& keys) {
+            std::vector<std::string> sample;
+            for (size_t i = 0; i < keys.size(); i += std::max<size_t>(1, keys.size() / 10000)) {
+                sample.push_back(keys[i]);
+            }
+            succinct::trie::KeyEncoder encoder(sample);
+            BuildOptions options;
+            options.key_encoder = &encoder;
+            return build_trie<Lexicographic>(keys, options);
+        });
+    }
+
+    // the centroid trie of get_keys(n) with the heavy children picked by
+    // the frequency of the keys in a Zipf query log (the distribution of
+    // zipf_positions(), another seed), see DefaultTreeBuilder::set_weighted()
+    inline const succinct::trie::DefaultPathDecomposedTrie<false>& get_weighted_trie(size_t n) {
+        return cached_trie(n, 0, [](const std::vector<std::string>& keys) {
+            std::vector<uint64_t> weights(keys.size(), 0);
+            for (auto p : zipf_positions(1 << 20, keys.size(), 1.0, 7)) ++weights[p];
+            BuildOptions options;
+            options.weights = &weights;
+            return build_trie<false>(keys, options);
+        });
+    }
+
+    // the trie of get_trie() with build_top_level_table(`budget_bytes`)
+    template <bool Lexicographic>
+    const succinct::trie::DefaultPathDecomposedTrie<Lexicographic>& get_top_level_trie(size_t n, size_t budget_bytes) {
+        return cached_trie(n, budget_bytes, [budget_bytes](const std::vector<std::string>& keys) {
+            auto trie = build_trie<Lexicographic>(keys, BuildOptions());
+            trie->build_top_level_table(budget_bytes);
+            return trie;
+        });
+    }
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_BENCH_UTIL_H
@@ -0,0 +1,70 @@
+//
+// dump_trie_stats: print the shape statistics (trie_stats.h) of the lexicographic
+// and centroid tries of a key set, as JSON.
+//
+//     dump_trie_stats <distribution | key file> [count] [seed]
+//
+// distribution: url | rocksdb | binary | words | path (see key_dataset.h),
+// a key file is one written by gen_keys.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include "key_dataset.h"
+#include "path_decomposed_trie.h"
+#include "trie_stats.h"
+
+template <bool Lexicographic>
+static void dump(const std::vector<std::string>& keys) {
+    succinct::DefaultTreeBuilder<Lexicographic> pdt_builder;
+    succinct::trie::compacted_trie_builder
+            <succinct::DefaultTreeBuilder<Lexicographic>>
+            trieBuilder(pdt_builder);
+    for (auto& key : keys) {
+        std::vector<uint8_t> bytes(key.begin(), key.end());
+        trieBuilder.append(bytes);
+    }
+    trieBuilder.finish();
+    succinct::trie::DefaultPathDecomposedTrie<Lexicographic> pdt(trieBuilder);
+
+    auto stats = succinct::trie::TrieStats::collect(pdt);
+    printf("  \"%s\": {\"bytes\": %llu, \"stats\": %s}",
+           Lexicographic ? "lex" : "centroid",
+           (unsigned long long)pdt.space_report().total_bytes(), stats.to_json().c_str());
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <distribution | key file> [count] [seed]\n", argv[0]);
+        return 1;
+    }
+    std::string source = argv[1];
+    size_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+    uint64_t seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 42;
+
+    std::vector<std::string> keys;
+    try {
+        if (std::ifstream(source)) {
+            keys = bench::read_key_file(source);
+            if (argc > 2 && count < keys.size()) keys.resize(count);
+        } else {
+            keys = bench::KeyGenerator(seed).generate(source, count);
+        }
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    bench::KeyStats key_stats = bench::key_stats(keys);
+    printf("{\n");
+    printf("  \"keys\": %llu, \"avg_key_length\": %.3f, \"avg_lcp\": %.3f,\n",
+           (unsigned long long)key_stats.count, key_stats.avg_length, key_stats.avg_lcp);
+    dump<true>(keys);
+    printf(",\n");
+    dump<false>(keys);
+    printf("\n}\n");
+    return 0;
+}
@@ -0,0 +1,41 @@
+//
+// gen_keys: write a deterministic key file for the benchmarks.
+//
+//     gen_keys <distribution> <count> <output file> [seed]
+//
+// distribution: url | rocksdb | binary | words | path
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "key_dataset.h"
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s <distribution> <count> <output file> [seed]\n", argv[0]);
+        fprintf(stderr, "distributions:");
+        for (auto& name : bench::KeyGenerator::distributions()) fprintf(stderr, " %s", name.c_str());
+        fprintf(stderr, "\n");
+        return 1;
+    }
+    std::string distribution = argv[1];
+    size_t count = std::strtoull(argv[2], nullptr, 10);
+    std::string output = argv[3];
+    uint64_t seed = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 42;
+
+    try {
+        bench::KeyGenerator generator(seed);
+        auto keys = generator.generate(distribution, count);
+        bench::write_key_file(output, distribution, seed, keys);
+        bench::KeyStats stats = bench::key_stats(keys);
+        printf("%s: distribution=%s seed=%llu count=%llu avg_length=%.2f avg_lcp=%.2f\n",
+               output.c_str(), distribution.c_str(), (unsigned long long)seed,
+               (unsigned long long)stats.count, stats.avg_length, stats.avg_lcp);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,286 @@
+//
+// Deterministic key datasets for the benchmarks.
+//
+// All generators are driven by std::mt19937_64 only (its output is fixed by the
+// standard, unlike the std::*_distribution classes), so a (distribution, count, seed)
+// triple gives byte-identical keys on every platform. The keys are always sorted,
+// distinct and prefix-free, i.e. ready to be appended to compacted_trie_builder.
+//
+// Key file format:
+//
+//     PDTKEYS 1\n
+//     distribution <name>\n
+//     seed <seed>\n
+//     count <n>\n
+//     avg_length <float>\n
+//     avg_lcp <float>\n
+//     \n
+//     n * (varint length + raw bytes)
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_KEY_DATASET_H
+#define PATH_DECOMPOSITION_TRIE_KEY_DATASET_H
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "varint_encode.h"
+
+namespace bench {
+    struct KeyStats {
+        uint64_t count = 0;
+        double avg_length = 0;
+        double avg_lcp = 0;         // longest common prefix of adjacent keys
+    };
+
+    inline KeyStats key_stats(const std::vector<std::string>& keys) {
+        KeyStats stats;
+        stats.count = keys.size();
+        if (keys.empty()) return stats;
+        uint64_t total_len = 0, total_lcp = 0;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            total_len += keys[i].size();
+            if (i) {
+                const std::string& a = keys[i - 1];
+                const std::string& b = keys[i];
+                size_t l = 0;
+                while (l < a.size() && l < b.size() && a[l] == b[l]) ++l;
+                total_lcp += l;
+            }
+        }
+        stats.avg_length = double(total_len) / keys.size();
+        stats.avg_lcp = keys.size() > 1 ? double(total_lcp) / (keys.size() - 1) : 0;
+        return stats;
+    }
+
+    class KeyGenerator {
+    public:
+        explicit KeyGenerator(uint64_t seed) : m_rng_(seed) {}
+
+        static const std::vector<std::string>& distributions() {
+            static const std::vector<std::string> names{"url", "rocksdb", "binary", "words", "path"};
+            return names;
+        }
+
+        // `n` sorted, distinct and prefix-free keys drawn from `distribution`.
+        // Rounds of fresh keys are added until the duplicates and prefixes
+        // removed by `normalize` are made up for.
+        std::vector<std::string> generate(const std::string& distribution, size_t n) {
+            std::vector<std::string> keys;
+            size_t stalled_rounds = 0;
+            while (keys.size() < n) {
+                size_t before = keys.size();
+                for (size_t i = keys.size(); i < n; ++i) {
+                    keys.push_back(next(distribution));
+                }
+                normalize(keys);
+                stalled_rounds = keys.size() > before ? 0 : stalled_rounds + 1;
+                if (stalled_rounds == 16) {
+                    throw std::runtime_error("distribution " + distribution + " cannot produce " +
+                                             std::to_string(n) + " distinct keys");
+                }
+            }
+            return keys;
+        }
+
+        std::string next(const std::string& distribution) {
+            if (distribution == "url") return url();
+            if (distribution == "rocksdb") return rocksdb_internal_key();
+            if (distribution == "binary") return binary();
+            if (distribution == "words") return word();
+            if (distribution == "path") return path();
+            throw std::invalid_argument("unknown key distribution: " + distribution);
+        }
+
+        // sort, dedup and remove every key that is a prefix of its successor
+        static void normalize(std::vector<std::string>& keys) {
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+            size_t out = 0;
+            for (size_t i = 0; i < keys.size(); ++i) {
+                if (i + 1 < keys.size() && keys[i + 1].compare(0, keys[i].size(), keys[i]) == 0) {
+                    continue;
+                }
+                keys[out++].swap(keys[i]);
+            }
+            keys.resize(out);
+        }
+
+    private:
+        uint64_t uniform(uint64_t n) {
+            return m_rng_() % n;
+        }
+
+        // rank in [0, n) skewed towards 0 (density ~ x^(-2/3)), for "popular" parts.
+        uint64_t skewed(uint64_t n) {
+            double u = double(m_rng_() >> 11) / double(1ULL << 53);
+            uint64_t r = uint64_t(double(n) * u * u * u);
+            return r < n ? r : n - 1;
+        }
+
+        static const char* syllable(uint64_t i) {
+            static const char* const sy[N_SYLLABLES] = {
+                    "ka", "to", "ri", "an", "be", "mo", "lu", "se", "ne", "di",
+                    "pa", "ro", "vi", "ta", "el", "or", "un", "co", "ma", "si",
+                    "ter", "con", "pro", "ing", "tion", "ment", "able", "ous", "er", "ly"};
+            return sy[i];
+        }
+
+        std::string syllables(size_t min, size_t max) {
+            size_t n = min + uniform(max - min + 1);
+            std::string s;
+            for (size_t i = 0; i < n; ++i) s += syllable(uniform(N_SYLLABLES));
+            return s;
+        }
+
+        // scheme://host/segments[?id=N], hosts and first segments are skewed
+        std::string url() {
+            static const char* const schemes[] = {"http://", "https://"};
+            static const char* const tlds[] = {".com", ".org", ".net", ".io", ".cn", ".de"};
+            std::string s = schemes[uniform(2)];
+            uint64_t host = skewed(5000);
+            if (host % 3 == 0) s += "www.";
+            s += word_of(host) + tlds[host % 6];
+            size_t depth = 1 + uniform(4);
+            for (size_t i = 0; i < depth; ++i) {
+                s += '/';
+                s += (i == 0) ? word_of(skewed(200)) : syllables(1, 4);
+            }
+            if (uniform(4) == 0) s += "?id=" + std::to_string(uniform(1000000));
+            return s;
+        }
+
+        // user key + 8-byte little-endian trailer (sequence << 8 | type), as in rocksdb InternalKey
+        std::string rocksdb_internal_key() {
+            std::string s;
+            if (uniform(2)) {
+                char buf[32];
+                snprintf(buf, sizeof(buf), "user%012llu", (unsigned long long)uniform(100000000000ULL));
+                s = buf;
+            } else {
+                s = word_of(skewed(10000)) + ":" + std::to_string(uniform(1000000));
+            }
+            uint64_t seq = uniform(1ULL << 56);
+            uint64_t type = uniform(2);   // kTypeDeletion / kTypeValue
+            uint64_t packed = (seq << 8) | type;
+            for (int i = 0; i < 8; ++i) {
+                s += static_cast<char>((packed >> (8 * i)) & 0xFF);
+            }
+            return s;
+        }
+
+        std::string binary() {
+            size_t len = 8 + uniform(17);
+            std::string s(len, '\0');
+            for (auto& c : s) c = static_cast<char>(uniform(256));
+            return s;
+        }
+
+        // dictionary-like words: common prefixes + stems + common suffixes
+        std::string word() {
+            static const char* const prefixes[] = {
+                    "", "", "", "un", "re", "in", "dis", "over", "inter", "counter",
+                    "trans", "super", "anti", "under", "pre", "multi"};
+            static const char* const suffixes[] = {
+                    "", "", "s", "ed", "ing", "er", "ers", "ly", "ness", "ment",
+                    "able", "ation", "ations", "ize", "ized", "izing"};
+            return std::string(prefixes[skewed(16)]) + word_of(skewed(30000)) + suffixes[uniform(16)];
+        }
+
+        // /top/dir/.../file.ext
+        std::string path() {
+            static const char* const tops[] = {"/usr", "/var", "/home", "/opt", "/etc", "/srv"};
+            static const char* const exts[] = {".c", ".h", ".cpp", ".txt", ".log", ".so", ".json", ""};
+            std::string s = tops[skewed(6)];
+            size_t depth = 1 + uniform(6);
+            for (size_t i = 0; i < depth; ++i) {
+                s += '/';
+                s += word_of(skewed(i < 2 ? 50 : 3000));
+            }
+            s += '/' + syllables(1, 3) + exts[uniform(8)];
+            return s;
+        }
+
+        // a pseudo word that only depends on `id`
+        static std::string word_of(uint64_t id) {
+            std::string s;
+            do {
+                s += syllable(id % N_SYLLABLES);
+                id /= N_SYLLABLES;
+            } while (id);
+            return s;
+        }
+
+        static const uint64_t N_SYLLABLES = 30;
+
+        std::mt19937_64 m_rng_;
+    };
+
+    inline void write_key_file(const std::string& file, const std::string& distribution,
+                               uint64_t seed, const std::vector<std::string>& keys) {
+        KeyStats stats = key_stats(keys);
+        std::ostringstream header;
+        header << "PDTKEYS 1\n"
+               << "distribution " << distribution << "\n"
+               << "seed " << seed << "\n"
+               << "count " << stats.count << "\n"
+               << "avg_length " << stats.avg_length << "\n"
+               << "avg_lcp " << stats.avg_lcp << "\n\n";
+
+        std::vector<uint8_t> body;
+        for (auto& key : keys) {
+            succinct::varint_encode_to(body, key.size());
+            body.insert(body.end(), key.begin(), key.end());
+        }
+
+        std::ofstream out(file, std::ios::binary);
+        if (!out) throw std::runtime_error("cannot open " + file);
+        std::string h = header.str();
+        out.write(h.data(), std::streamsize(h.size()));
+        out.write(reinterpret_cast<const char*>(body.data()), std::streamsize(body.size()));
+    }
+
+    inline std::vector<std::string> read_key_file(const std::string& file, KeyStats* stats = nullptr) {
+        std::ifstream in(file, std::ios::binary);
+        if (!in) throw std::runtime_error("cannot open " + file);
+        std::string line;
+        std::getline(in, line);
+        if (line != "PDTKEYS 1") throw std::runtime_error(file + " is not a key file");
+        KeyStats file_stats;
+        while (std::getline(in, line) && !line.empty()) {
+            std::istringstream field(line);
+            std::string name;
+            field >> name;
+            if (name == "count") field >> file_stats.count;
+            else if (name == "avg_length") field >> file_stats.avg_length;
+            else if (name == "avg_lcp") field >> file_stats.avg_lcp;
+        }
+        std::vector<uint8_t> body((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        std::vector<std::string> keys;
+        keys.reserve(file_stats.count);
+        size_t offset = 0;
+        while (offset < body.size()) {
+            // the length varint and the key bytes must both be in the body
+            size_t end = offset;
+            while (end < body.size() && (body[end] & 0x80)) ++end;
+            if (end == body.size()) throw std::runtime_error(file + " is truncated");
+            size_t len;
+            offset += succinct::varint_decode_from(body, offset, len);
+            if (len > body.size() - offset) throw std::runtime_error(file + " is truncated");
+            keys.emplace_back(body.begin() + ptrdiff_t(offset), body.begin() + ptrdiff_t(offset + len));
+            offset += len;
+        }
+        if (keys.size() != file_stats.count) throw std::runtime_error(file + " is truncated");
+        if (stats) *stats = file_stats;
+        return keys;
+    }
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_KEY_DATASET_H
@@ -5,8 +5,44 @@
 #ifndef PATH_DECOMPOSITION_TRIE_BIT_UTIL_H
 #define PATH_DECOMPOSITION_TRIE_BIT_UTIL_H
 
+#include <cassert>
+#include <cstddef>
 #include <cstdint>
 
+// Hardware paths of popcount / msb / lsb / select_in_word, chosen at compile
+// time from the target flags (e.g. -march=native, see PDT_NATIVE_ARCH in
+// CMakeLists.txt). Defining PDT_PORTABLE_BITOPS forces the broadword code.
+//
+//   PDT_HW_POPCOUNT: POPCNT on x86-64, CNT on AArch64
+//   PDT_HW_SELECT:   PDEP + TZCNT (BMI2). PDEP is microcoded on AMD before
+//                    Zen 3 and much slower than the broadword select there.
+//   PDT_HW_BIT_SCAN: LZCNT/TZCNT (BSR/BSF without them) on x86-64, CLZ on AArch64
+//   PDT_HW_SSE2, PDT_HW_AVX2, PDT_HW_AVX512BW: the vector excess kernels of
+//                    balanced_parentheses_vector.cpp and the branch search of branch_search.h
+#if !defined(PDT_PORTABLE_BITOPS) && (defined(__GNUC__) || defined(__clang__))
+#   if defined(__POPCNT__) || defined(__aarch64__)
+#       define PDT_HW_POPCOUNT 1
+#   endif
+#   if defined(__BMI2__) && defined(__x86_64__)
+#       define PDT_HW_SELECT 1
+#       include <immintrin.h>
+#   endif
+#   if defined(__x86_64__) || defined(__aarch64__)
+#       define PDT_HW_BIT_SCAN 1
+#   endif
+#   if defined(__SSE2__) && defined(__x86_64__)
+#       define PDT_HW_SSE2 1
+#       include <emmintrin.h>
+#   endif
+#   if defined(__AVX2__) && defined(__x86_64__)
+#       define PDT_HW_AVX2 1
+#       include <immintrin.h>
+#   endif
+#   if defined(__AVX512BW__) && defined(__x86_64__)
+#       define PDT_HW_AVX512BW 1
+#   endif
+#endif
+
 namespace succinct {
     namespace util {
         static const uint64_t MAGIC_MASK_1 = 0x5555555555555555ULL;
@@ -123,10 +159,18 @@ namespace succinct {
 
         // count set-bits in `x`.
         // idea: Divide & Conquer, similar with `reserve_bits`
-        inline uint64_t popcount(uint64_t x) {
+        inline uint64_t broadword_popcount(uint64_t x) {
             return bytes_sum(byte_counts(x));
         }
 
+        inline uint64_t popcount(uint64_t x) {
+#ifdef PDT_HW_POPCOUNT
+            return static_cast<uint64_t>(__builtin_popcountll(x));
+#else
+            return broadword_popcount(x);
+#endif
+        }
+
         // REQUIRE: x has only 1 bit set.
         inline uint8_t bit_position(uint64_t x) {
             assert(popcount(x) == 1);
@@ -134,7 +178,7 @@ namespace succinct {
         }
 
         // RETURN: true if MSB exists and set `ret` to the index of MSB
-        inline bool msb(uint64_t x, unsigned long& ret) {
+        inline bool broadword_msb(uint64_t x, unsigned long& ret) {
             if (!x) {
                 return false;
             }
@@ -151,6 +195,18 @@ namespace succinct {
             return true;
         }
 
+        inline bool msb(uint64_t x, unsigned long& ret) {
+#ifdef PDT_HW_BIT_SCAN
+            if (!x) {
+                return false;
+            }
+            ret = 63 - static_cast<unsigned long>(__builtin_clzll(x));
+            return true;
+#else
+            return broadword_msb(x, ret);
+#endif
+        }
+
         // REQUIRE: x != 0
         inline uint8_t msb(uint64_t x)
         {
@@ -161,7 +217,7 @@ namespace succinct {
         }
 
         // RETURN: true if LSB exists and set `ret` to the index of LSB
-        inline bool lsb(uint64_t x, unsigned long& ret) {
+        inline bool broadword_lsb(uint64_t x, unsigned long& ret) {
             if (!x) {
                 return false;
             }
@@ -169,6 +225,18 @@ namespace succinct {
             return true;
         }
 
+        inline bool lsb(uint64_t x, unsigned long& ret) {
+#ifdef PDT_HW_BIT_SCAN
+            if (!x) {
+                return false;
+            }
+            ret = static_cast<unsigned long>(__builtin_ctzll(x));
+            return true;
+#else
+            return broadword_lsb(x, ret);
+#endif
+        }
+
         // REQUIRE: x != 0
         inline uint8_t lsb(uint64_t x)
         {
@@ -185,7 +253,7 @@ namespace succinct {
 
         // get position of `k`-th 1-bit in `x`.
         // `k` starts from 0.
-        inline uint64_t select_in_word(const uint64_t x, const uint64_t k) {
+        inline uint64_t broadword_select_in_word(const uint64_t x, const uint64_t k) {
             assert(k < popcount(x));
 
             uint64_t byte_sums = byte_counts(x) * BYTE_UNIT;
@@ -203,6 +271,16 @@ namespace succinct {
             return byte_block_pos +
                 select_in_byte[((x >> byte_block_pos) & (uint64_t(0xFF))) | (byte_rank << 8)];
         }
+
+        inline uint64_t select_in_word(const uint64_t x, const uint64_t k) {
+#ifdef PDT_HW_SELECT
+            assert(k < popcount(x));
+            // deposit bit `k` onto the `k`-th 1-bit of `x`
+            return static_cast<uint64_t>(__builtin_ctzll(_pdep_u64(1ULL << k, x)));
+#else
+            return broadword_select_in_word(x, k);
+#endif
+        }
     }
 }
 
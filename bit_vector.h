@@ -5,10 +5,13 @@
 #ifndef PATH_DECOMPOSITION_TRIE_BIT_VECTOR_H
 #define PATH_DECOMPOSITION_TRIE_BIT_VECTOR_H
 
+#include <algorithm>
 #include <vector>
 
 #include "bit_util.h"
 #include "mappable_vector.h"
+#include "perf_counters.h"
+#include "space_report.h"
 
 namespace succinct {
     class BitVectorBuilder {
@@ -244,6 +247,12 @@ namespace succinct {
             return m_size_;
         }
 
+        SpaceReport space_report() const {
+            SpaceReport report;
+            report.add("bits", m_bits_);
+            return report;
+        }
+
         // get bit at `pos`.
         inline bool operator[](uint64_t pos) const {
             assert(pos < m_size_);
@@ -286,6 +295,7 @@ namespace succinct {
         // TODO: Is it OK for all set BitVector?
         inline uint64_t predecessor0(uint64_t pos) const {
             assert(pos < m_size_);
+            PDT_COUNT(PREDECESSOR0);
             uint64_t block = pos / 64;
             uint64_t shift = 64 - pos % 64 - 1;
             uint64_t word = ~m_bits_[block];
@@ -293,6 +303,7 @@ namespace succinct {
 
             unsigned long ret;
             while (!util::msb(word, ret)) {
+                PDT_COUNT(PREDECESSOR0_WORDS);
                 assert(block);
                 word = ~m_bits_[--block];
             }
@@ -305,9 +316,11 @@ namespace succinct {
             uint64_t block = pos / 64;
             uint64_t shift = pos % 64;
             uint64_t word = (~m_bits_[block] >> shift) << shift;
+            PDT_COUNT(SUCCESSOR0);
 
             unsigned long ret;
             while (!util::lsb(word, ret)) {
+                PDT_COUNT(SUCCESSOR0_WORDS);
                 ++block;
                 assert(block < m_bits_.size());
                 word = ~m_bits_[block];
@@ -351,6 +364,21 @@ namespace succinct {
             return m_bits_;
         }
 
+        // number of 64-bit words
+        inline uint64_t word_count() const {
+            return m_bits_.size();
+        }
+
+        // `i`-th 64-bit word, the word access BasicBpVector shares with
+        // InterleavedRsBitVector
+        inline uint64_t word_at(uint64_t i) const {
+            return m_bits_[i];
+        }
+
+        inline const uint64_t* word_ptr(uint64_t i) const {
+            return m_bits_.data() + i;
+        }
+
         // ------------ the bitwise iterator of BitVector -------------
         struct enumerator {
             enumerator():
@@ -0,0 +1,103 @@
+//
+// Search of a branching symbol in a run of light branches (`m_branches`).
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_BRANCH_SEARCH_H
+#define PATH_DECOMPOSITION_TRIE_BRANCH_SEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bit_util.h"
+
+namespace succinct {
+    namespace trie {
+        // Sorted runs at least this wide are binary searched, the crossover
+        // against the vector scan measured by bench_branch_search. A run has
+        // at most 256 branches, AVX-512 scans them faster than the search.
+#if defined(PDT_HW_AVX512BW)
+        static const size_t BRANCH_BINARY_SEARCH_MIN = 257;
+#elif defined(PDT_HW_AVX2)
+        static const size_t BRANCH_BINARY_SEARCH_MIN = 64;
+#else
+        static const size_t BRANCH_BINARY_SEARCH_MIN = 32;
+#endif
+
+        // Most runs have a few branches, a compare loop beats setting up the vectors.
+        static const size_t BRANCH_SCALAR_SCAN_MAX = 8;
+
+        // index of the first `c` in `branches[0, n)`, `n` if there is none.
+        // 32 (AVX-512BW), 16 (AVX2) or 8 (SSE2) symbols per compare, scalar tail.
+        inline size_t scan_branches(const uint16_t* branches, size_t n, uint16_t c) {
+            size_t i = 0;
+            if (n < BRANCH_SCALAR_SCAN_MAX) {
+                for (; i < n; ++i) {
+                    if (branches[i] == c) return i;
+                }
+                return n;
+            }
+#if defined(PDT_HW_AVX512BW)
+            const __m512i key = _mm512_set1_epi16(short(c));
+            for (; i < n; i += 32) {
+                // masked load, the lanes past `n` are not read
+                __mmask32 valid = n - i >= 32 ? ~__mmask32(0) : __mmask32((1U << (n - i)) - 1);
+                uint32_t hits = _mm512_mask_cmpeq_epi16_mask(
+                        valid, _mm512_maskz_loadu_epi16(valid, branches + i), key);
+                if (hits) return i + util::lsb(hits);
+            }
+            return n;
+#else
+#if defined(PDT_HW_AVX2)
+            const __m256i key = _mm256_set1_epi16(short(c));
+            for (; i + 16 <= n; i += 16) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(branches + i));
+                // 2 bits per symbol
+                uint32_t hits = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi16(v, key)));
+                if (hits) return i + util::lsb(hits) / 2;
+            }
+#endif
+#if defined(PDT_HW_SSE2)
+            const __m128i key8 = _mm_set1_epi16(short(c));
+            for (; i + 8 <= n; i += 8) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(branches + i));
+                uint32_t hits = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi16(v, key8)));
+                if (hits) return i + util::lsb(hits) / 2;
+            }
+#endif
+            for (; i < n; ++i) {
+                if (branches[i] == c) return i;
+            }
+            return n;
+#endif
+        }
+
+        // index of `c` in the strictly decreasing `branches[0, n)` (the runs
+        // of the lexicographic trie), `n` if there is none. Branchless: the
+        // halving step compiles to a conditional move.
+        inline size_t search_sorted_branches(const uint16_t* branches, size_t n, uint16_t c) {
+            if (!n) return 0;
+            const uint16_t* base = branches;
+            size_t len = n;
+            // `base` ends on the last symbol >= c
+            while (len > 1) {
+                size_t half = len / 2;
+                base = base[half] >= c ? base + half : base;
+                len -= half;
+            }
+            return *base == c ? size_t(base - branches) : n;
+        }
+
+        // `Sorted`: the runs are strictly decreasing, as in the lexicographic trie.
+        // In the centroid trie a run is the non heavy children in reverse
+        // order, where WORD_EOF (the first child) comes last.
+        template <bool Sorted>
+        inline size_t find_branch(const uint16_t* branches, size_t n, uint16_t c) {
+            if (Sorted && n >= BRANCH_BINARY_SEARCH_MIN) {
+                return search_sorted_branches(branches, n, c);
+            }
+            return scan_branches(branches, n, c);
+        }
+    }
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_BRANCH_SEARCH_H
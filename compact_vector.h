@@ -0,0 +1,108 @@
+//
+// Fixed-width bit-packed vector of integers.
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_COMPACT_VECTOR_H
+#define PATH_DECOMPOSITION_TRIE_COMPACT_VECTOR_H
+
+#include <algorithm>
+#include <vector>
+
+#include "bit_util.h"
+#include "mappable_vector.h"
+#include "space_report.h"
+
+namespace succinct {
+    //
+    // `size()` integers of `width()` bits each, packed back to back in 64-bit
+    // words (little endian inside the words, as BitVector). The width is the
+    // one of the largest value unless it is given. A padding word after the
+    // last value lets `operator[]` always read two words without a branch.
+    //
+    class CompactVector {
+    public:
+        CompactVector() : m_size_(0), m_width_(0), m_mask_(0) {}
+
+        explicit CompactVector(const std::vector<uint64_t>& values, uint64_t width = 0)
+                : m_size_(values.size()) {
+            if (!width) {
+                uint64_t max_value = values.empty() ? 0 : *std::max_element(values.begin(), values.end());
+                width = bits_for(max_value);
+            }
+            assert(width <= 64);
+            m_width_ = width;
+            m_mask_ = width == 64 ? uint64_t(-1) : (uint64_t(1) << width) - 1;
+
+            std::vector<uint64_t> words((m_size_ * m_width_ + 63) / 64 + 1, 0);
+            for (uint64_t i = 0; i < m_size_; ++i) {
+                assert((values[i] & m_mask_) == values[i]);
+                uint64_t pos = i * m_width_;
+                uint64_t shift = pos % 64;
+                words[pos / 64] |= values[i] << shift;
+                if (shift + m_width_ > 64) {
+                    words[pos / 64 + 1] |= values[i] >> (64 - shift);
+                }
+            }
+            m_bits_.steal(words);
+        }
+
+        void swap(CompactVector& other) {
+            std::swap(m_size_, other.m_size_);
+            std::swap(m_width_, other.m_width_);
+            std::swap(m_mask_, other.m_mask_);
+            m_bits_.swap(other.m_bits_);
+        }
+
+        // bits of `v`, at least 1
+        static uint64_t bits_for(uint64_t v) {
+            unsigned long msb = 0;
+            return util::msb(v, msb) ? msb + 1 : 1;
+        }
+
+        inline uint64_t size() const {
+            return m_size_;
+        }
+
+        inline bool empty() const {
+            return !m_size_;
+        }
+
+        inline uint64_t width() const {
+            return m_width_;
+        }
+
+        inline uint64_t operator[](uint64_t i) const {
+            assert(i < m_size_);
+            uint64_t pos = i * m_width_;
+            uint64_t block = pos / 64;
+            uint64_t shift = pos % 64;
+            // `<< (63 - shift) << 1` is 0 for shift == 0, where `<< 64` would be undefined
+            return ((m_bits_[block] >> shift) | (m_bits_[block + 1] << (63 - shift) << 1)) & m_mask_;
+        }
+
+        // the first word holding the `i`-th value, for the trace
+        inline const uint64_t* word_ptr(uint64_t i) const {
+            return m_bits_.data() + i * m_width_ / 64;
+        }
+
+        const mappable_vector<uint64_t>& data() const {
+            return m_bits_;
+        }
+
+        uint64_t bytes() const {
+            return m_bits_.bytes();
+        }
+
+        bool is_owned() const {
+            return m_bits_.is_owned();
+        }
+
+    private:
+        uint64_t m_size_;
+        uint64_t m_width_;
+        uint64_t m_mask_;
+        mappable_vector<uint64_t> m_bits_;
+    };
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_COMPACT_VECTOR_H
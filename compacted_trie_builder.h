@@ -5,11 +5,14 @@
 #ifndef PATH_DECOMPOSITION_TRIE_COMPACTED_TRIE_BUILDER_H
 #define PATH_DECOMPOSITION_TRIE_COMPACTED_TRIE_BUILDER_H
 
+#include <cassert>
 #include <vector>
 #include <string>
 #include <algorithm>
 #include <memory>
 
+#include "key_encoder.h"
+
 namespace succinct {
     namespace trie {
         template <typename TreeBuilder>
@@ -19,13 +22,27 @@ namespace succinct {
 
             compacted_trie_builder &operator=(const compacted_trie_builder&) = delete;
 
-            compacted_trie_builder(TreeBuilder& builder_)
-                : is_finish_(false), builder(builder_) {
+            // `encoder` (key_encoder.h, kept by the caller until the trie is
+            // built) is applied to every key appended, and by the trie to
+            // its queries and results
+            compacted_trie_builder(TreeBuilder& builder_, const KeyEncoder* encoder = nullptr)
+                : is_finish_(false), builder(builder_), encoder_(encoder) {
                 assert(node_stack.empty() && last_string.empty());
             }
 
             void append(std::vector<uint8_t>& raw_bytes) {
-                std::vector<uint16_t> bytes(raw_bytes.begin(), raw_bytes.end());
+                append(raw_bytes, 1);
+            }
+
+            // `weight`: e.g. the query frequency of the key, for
+            // `DefaultTreeBuilder::set_weighted()`
+            void append(std::vector<uint8_t>& raw_bytes, uint64_t weight) {
+                std::vector<uint16_t> bytes;
+                if (encoder_ && !encoder_->empty()) {
+                    encoder_->encode(raw_bytes.data(), raw_bytes.size(), bytes);
+                } else {
+                    bytes.assign(raw_bytes.begin(), raw_bytes.end());
+                }
                 bytes.push_back(1024);
 
                 assert(!is_finish_);
@@ -34,7 +51,7 @@ namespace succinct {
                 if (node_stack.empty()) {
                     // first bytes
                     last_string.assign(bytes.begin(), bytes.end());
-                    node_stack.push_back(node(0, last_string.size()));
+                    node_stack.push_back(node(0, last_string.size(), weight));
                 } else {
                     size_t min_len = std::min(bytes.size(), last_string.size());
                     auto match_res =
@@ -63,7 +80,8 @@ namespace succinct {
                     for (size_t idx = node_stack.size() - 1; idx > split_node_idx; idx--) {
                         node& child = node_stack[idx];
                         typename TreeBuilder::representation_type subtrie =
-                                builder.node(child.children, &last_string[0], child.path_len, child.skip);
+                                builder.node(child.children, &last_string[0], child.path_len, child.skip,
+                                             child.weight);
                         uint16_t branch_byte = last_string[child.path_len - 1];
                         node_stack[idx - 1].children.push_back(std::make_pair(branch_byte, subtrie));
                     }
@@ -74,7 +92,8 @@ namespace succinct {
                         typename TreeBuilder::representation_type subtrie =
                                 builder.node(split_node.children, &last_string[0],
                                         mismatch_idx + 1,
-                                        split_node.path_len + split_node.skip - mismatch_idx - 1);
+                                        split_node.path_len + split_node.skip - mismatch_idx - 1,
+                                        split_node.weight);
                         uint16_t branching_char = last_string[mismatch_idx];
                         split_node.children.clear();
                         split_node.children.push_back(std::make_pair(branching_char, subtrie));
@@ -83,7 +102,7 @@ namespace succinct {
 
                     assert(split_node.path_len + split_node.skip == mismatch_idx);
                     // open a new leaf with the current suffix
-                    node_stack.push_back(node(mismatch_idx + 1, bytes.size() - mismatch_idx - 1));
+                    node_stack.push_back(node(mismatch_idx + 1, bytes.size() - mismatch_idx - 1, weight));
 
                     // copy the current string (iter could be invalid in next iteration)
                     last_string.assign(bytes.begin(), bytes.end());
@@ -98,14 +117,15 @@ namespace succinct {
                 for (size_t node_idx = node_stack.size() - 1; node_idx > 0; --node_idx) {
                     node& child = node_stack[node_idx];
                     typename TreeBuilder::representation_type subtrie =
-                            builder.node(child.children, &last_string[0], child.path_len, child.skip);
+                            builder.node(child.children, &last_string[0], child.path_len, child.skip,
+                                         child.weight);
                     uint16_t branching_char = last_string[child.path_len - 1];
                     node_stack[node_idx - 1].children.push_back(std::make_pair(branching_char, subtrie));
                 }
 
                 typename TreeBuilder::representation_type root =
                         builder.node(node_stack[0].children, &last_string[0],
-                                      node_stack[0].path_len, node_stack[0].skip);
+                                      node_stack[0].path_len, node_stack[0].skip, node_stack[0].weight);
                 builder.root(root);
                 node_stack.clear();
 
@@ -120,21 +140,29 @@ namespace succinct {
                 return builder.get_root();
             }
 
+            // nullptr without encoder
+            const KeyEncoder* key_encoder() const {
+                return encoder_;
+            }
+
         private:
             struct node {
                 node()
                         : skip(-1)
+                        , weight(1)
                 {}
 
-                node(size_t path_len_, size_t skip_)
+                node(size_t path_len_, size_t skip_, uint64_t weight_)
                         : path_len(path_len_)
                         , skip(skip_)
+                        , weight(weight_)
                 {}
 
                 size_t get_end() { return path_len + skip; }
 
                 size_t path_len;
                 size_t skip;
+                uint64_t weight;        // of the key ending here, for a leaf
 
                 typedef std::pair<uint16_t, typename TreeBuilder::representation_type> subtrie;
                 std::vector<subtrie> children;
@@ -143,6 +171,7 @@ namespace succinct {
             bool is_finish_;            // Is building process finish?
 
             TreeBuilder& builder;
+            const KeyEncoder* encoder_;
             std::vector<node> node_stack;
             std::vector<uint16_t> last_string;
 
@@ -0,0 +1,177 @@
+//
+// darray (Okanohara and Sadakane, "Practical Entropy-Compressed Rank/Select
+// Dictionary"): select over sampled positions, without a rank directory.
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_DARRAY_H
+#define PATH_DECOMPOSITION_TRIE_DARRAY_H
+
+#include "bit_vector.h"
+
+namespace succinct {
+    //
+    // Select of the `Bit` bits (1 or 0) of a bit vector that provides
+    // `word_at()` / `word_count()` / `size()` (BitVector, RsBitVector,
+    // InterleavedRsBitVector, BpVector). The darray does not keep a reference
+    // to the bit vector, it is passed again to `select()`.
+    //
+    // The positions of the `Bit` bits are cut in blocks of `block_size`:
+    //
+    //   - dense block (span < `max_in_block_distance`): the position of its
+    //     first bit in `m_block_inventory_`, and the offset of every
+    //     `subblock_size`-th bit from there in 16 bits (`m_subblock_inventory_`).
+    //     select reads the two samples and counts the rest of the bits from
+    //     the sampled one, at most `subblock_size` - 1 bits.
+    //
+    //   - sparse block: all its positions in `m_overflow_positions_`, the
+    //     inventory entry is -(offset + 1).
+    //
+    // At 1/2 density the inventories are about 3% of the bits each.
+    //
+    template <bool Bit>
+    class Darray {
+    public:
+        static const uint64_t block_size = 1024;
+        static const uint64_t subblock_size = 256;
+        static const uint64_t max_in_block_distance = 1 << 16;
+
+        Darray() : m_positions_(0) {}
+
+        template <typename BitVectorType>
+        explicit Darray(const BitVectorType& bv) : m_positions_(0) {
+            std::vector<int64_t> block_inventory;
+            std::vector<uint16_t> subblock_inventory;
+            std::vector<uint64_t> overflow_positions;
+            std::vector<uint64_t> cur_block_positions;
+
+            for (uint64_t word_idx = 0; word_idx < bv.word_count(); ++word_idx) {
+                uint64_t cur_pos = word_idx * 64;
+                uint64_t cur_word = get_word(bv, word_idx);
+                unsigned long l;
+                while (util::lsb(cur_word, l)) {
+                    cur_pos += l;
+                    cur_word >>= l;
+                    if (cur_pos >= bv.size()) break;
+
+                    cur_block_positions.push_back(cur_pos);
+                    if (cur_block_positions.size() == block_size) {
+                        flush_cur_block(cur_block_positions, block_inventory,
+                                        subblock_inventory, overflow_positions);
+                    }
+
+                    // can't do >>= l + 1, it can be 64
+                    cur_word >>= 1;
+                    cur_pos += 1;
+                    m_positions_ += 1;
+                }
+            }
+            if (cur_block_positions.size()) {
+                flush_cur_block(cur_block_positions, block_inventory,
+                                subblock_inventory, overflow_positions);
+            }
+
+            m_block_inventory_.steal(block_inventory);
+            m_subblock_inventory_.steal(subblock_inventory);
+            m_overflow_positions_.steal(overflow_positions);
+        }
+
+        void swap(Darray& other) {
+            std::swap(m_positions_, other.m_positions_);
+            m_block_inventory_.swap(other.m_block_inventory_);
+            m_subblock_inventory_.swap(other.m_subblock_inventory_);
+            m_overflow_positions_.swap(other.m_overflow_positions_);
+        }
+
+        SpaceReport space_report() const {
+            SpaceReport report;
+            report.add("block_inventory", m_block_inventory_);
+            report.add("subblock_inventory", m_subblock_inventory_);
+            report.add("overflow_positions", m_overflow_positions_);
+            return report;
+        }
+
+        // number of `Bit` bits
+        inline uint64_t num_positions() const {
+            return m_positions_;
+        }
+
+        // position of the `n`-th `Bit` bit of `bv` (the bit vector the darray
+        // was built on), `n` starts from 0
+        template <typename BitVectorType>
+        inline uint64_t select(const BitVectorType& bv, uint64_t n) const {
+            assert(n < num_positions());
+            if (Bit) {
+                PDT_COUNT(SELECT);
+            } else {
+                PDT_COUNT(SELECT0);
+            }
+            uint64_t block = n / block_size;
+            int64_t block_pos = m_block_inventory_[block];
+            if (block_pos < 0) {
+                uint64_t overflow_pos = uint64_t(-block_pos - 1);
+                return m_overflow_positions_[overflow_pos + (n % block_size)];
+            }
+
+            uint64_t start_pos = uint64_t(block_pos) + m_subblock_inventory_[n / subblock_size];
+            uint64_t remainder = n % subblock_size;
+            if (!remainder) return start_pos;
+
+            uint64_t word_idx = start_pos / 64;
+            uint64_t word_shift = start_pos % 64;
+            uint64_t word = get_word(bv, word_idx) & (uint64_t(-1) << word_shift);
+
+            while (true) {
+                uint64_t popcnt = util::popcount(word);
+                if (remainder < popcnt) break;
+                if (Bit) {
+                    PDT_COUNT(SELECT_STEPS);
+                } else {
+                    PDT_COUNT(SELECT0_STEPS);
+                }
+                remainder -= popcnt;
+                word = get_word(bv, ++word_idx);
+            }
+            return 64 * word_idx + util::select_in_word(word, remainder);
+        }
+
+    protected:
+        // the `word_idx`-th word of `bv` with the `Bit` bits set
+        template <typename BitVectorType>
+        static inline uint64_t get_word(const BitVectorType& bv, uint64_t word_idx) {
+            uint64_t word = bv.word_at(word_idx);
+            return Bit ? word : ~word;
+        }
+
+        static void flush_cur_block(std::vector<uint64_t>& cur_block_positions,
+                                    std::vector<int64_t>& block_inventory,
+                                    std::vector<uint16_t>& subblock_inventory,
+                                    std::vector<uint64_t>& overflow_positions) {
+            if (cur_block_positions.back() - cur_block_positions.front() < max_in_block_distance) {
+                block_inventory.push_back(int64_t(cur_block_positions.front()));
+                for (size_t i = 0; i < cur_block_positions.size(); i += subblock_size) {
+                    subblock_inventory.push_back(
+                            uint16_t(cur_block_positions[i] - cur_block_positions.front()));
+                }
+            } else {
+                block_inventory.push_back(-int64_t(overflow_positions.size()) - 1);
+                overflow_positions.insert(overflow_positions.end(),
+                                          cur_block_positions.begin(), cur_block_positions.end());
+                // keeps the sub-inventory of the next blocks at n / subblock_size
+                for (size_t i = 0; i < cur_block_positions.size(); i += subblock_size) {
+                    subblock_inventory.push_back(uint16_t(-1));
+                }
+            }
+            cur_block_positions.clear();
+        }
+
+        uint64_t m_positions_;
+        mappable_vector<int64_t> m_block_inventory_;
+        mappable_vector<uint16_t> m_subblock_inventory_;
+        mappable_vector<uint64_t> m_overflow_positions_;
+    };
+
+    typedef Darray<true> Darray1;
+    typedef Darray<false> Darray0;
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_DARRAY_H
@@ -5,14 +5,35 @@
 #ifndef PATH_DECOMPOSITION_TRIE_DEFAULT_TREE_BUILDER_H
 #define PATH_DECOMPOSITION_TRIE_DEFAULT_TREE_BUILDER_H
 
+#include <cassert>
+#include <cstdint>
+#include <limits>
 #include <vector>
 #include <memory>
 #include "bit_vector.h"
+#include "trie_stats.h"
 
 namespace succinct {
     template <bool Lexicographic = false>
     class DefaultTreeBuilder {
     public:
+        DefaultTreeBuilder() : m_stats(nullptr), m_weighted(false) {}
+
+        // collect the shape statistics of the compacted trie into `stats` while building
+        void set_stats(trie::TrieStats* stats) {
+            m_stats = stats;
+        }
+
+        // Centroid only: pick the heavy child by the total weight of its
+        // keys, the weights of `compacted_trie_builder::append(key, weight)`
+        // (1 without), ties by subtree size. Weighted by query frequency the
+        // frequent keys get the fewest light edges; with unit weights it is
+        // the centroid decomposition.
+        void set_weighted(bool weighted) {
+            assert(!Lexicographic || !weighted);
+            m_weighted = weighted;
+        }
+
         // node label is encoded by uint16_t:
         //
         //        special_char_flag (uint8_t: 0/1/2) + char/branching number (uint8_t)
@@ -32,8 +53,9 @@ namespace succinct {
             // m_num_leaves is used to check if m_decomposition_branches & m_bp is right.
             // TODO: remove m_num_leaves if it is checked
             size_t m_num_leaves;
+            uint64_t m_weight;                   // sum of the weights of the keys
 
-            subtree() : m_num_leaves(1) {}
+            subtree() : m_num_leaves(1), m_weight(1) {}
 
             size_t size() const {
                 // each decomposition branch has at least one leaf
@@ -80,10 +102,12 @@ namespace succinct {
         typedef std::shared_ptr<subtree> representation_type;
         typedef std::vector<std::pair<uint16_t, representation_type>> children_type;
 
+        // `weight`: the weight of the key of a leaf
         representation_type node(
                 children_type& children, const uint16_t* buf,
-                size_t offset, size_t skip) {
+                size_t offset, size_t skip, uint64_t weight = 1) {
             representation_type ret;
+            if (m_stats) m_stats->add_compacted_node(children.size(), skip);
 
             if (children.size()) {
                 // prefix-free
@@ -92,6 +116,20 @@ namespace succinct {
                 size_t largest_child = -1;
                 if (Lexicographic) {
                     largest_child = 0;
+                } else if (m_weighted) {
+                    uint64_t largest_child_weight = 0;
+                    size_t largest_child_size = 0;
+
+                    for (size_t i = 0; i < children.size(); ++i) {
+                        uint64_t w = children[i].second->m_weight;
+                        size_t size = children[i].second->size();
+                        if (i == 0 || w > largest_child_weight ||
+                            (w == largest_child_weight && size > largest_child_size)) {
+                            largest_child = i;
+                            largest_child_weight = w;
+                            largest_child_size = size;
+                        }
+                    }
                 } else {
                     size_t largest_child_size = 0;
 
@@ -103,6 +141,8 @@ namespace succinct {
                     }
                 }
                 assert(largest_child != -1);
+                uint64_t total_weight = 0;
+                for (auto& child : children) total_weight += child.second->m_weight;
                 // Pick heavy subtrie from compacted trie.
                 children[largest_child].second.swap(ret);
                 size_t n_branches = children.size() - 1;
@@ -118,8 +158,10 @@ namespace succinct {
                         children[i].second->append_to(*ret);
                     }
                 }
+                ret->m_weight = total_weight;
             } else {
                 ret = std::make_shared<subtree>();
+                ret->m_weight = weight;
             }
 
             // append in reverse order
@@ -153,6 +195,8 @@ namespace succinct {
         }
     private:
         representation_type m_root_node;
+        trie::TrieStats* m_stats;
+        bool m_weighted;
     };
 }
 
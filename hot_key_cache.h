@@ -0,0 +1,204 @@
+//
+// Lock-free cache of `index()` results in front of a trie, for skewed
+// lookup distributions.
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_HOT_KEY_CACHE_H
+#define PATH_DECOMPOSITION_TRIE_HOT_KEY_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "space_report.h"
+
+namespace succinct {
+    namespace trie {
+        //
+        // Set-associative table of 64-byte sets of `WAYS` slots, sized by a
+        // memory budget, in front of `trie.index()` (any trie with a const,
+        // thread-safe `index(const std::string&)`). Both the ids and the -1 of
+        // absent keys are cached.
+        //
+        // A slot is two relaxed atomic words, `data` (the result, with an
+        // occupied bit) and `check` = hash ^ data, as the lockless hash tables
+        // of chess engines: a reader whose slot is torn by a concurrent writer
+        // sees `check ^ data != hash` and takes it as a miss, so `index()` is
+        // safe from any number of threads without locks or retries. A hit
+        // compares the whole 64-bit hash of the key, not the key itself.
+        //
+        // The set is picked by the low bits of the hash, an insertion takes
+        // the free slot of the set or evicts a random one, drawn from a
+        // per-thread xorshift generator (random replacement: a hit never
+        // writes, the hot sets stay shared in the readers' caches; the way
+        // is not a function of the key, so two hot keys of a set do not keep
+        // evicting each other).
+        //
+        // Hits and misses are counted in per-thread stripes on their own cache
+        // lines, see `stats()`.
+        //
+        template <typename TrieType>
+        class HotKeyCache {
+        public:
+            static const size_t WAYS = 4;
+
+            struct Stats {
+                uint64_t hits = 0;
+                uint64_t misses = 0;
+            };
+
+            // the largest power of two number of sets within `memory_budget_bytes`,
+            // at least one
+            HotKeyCache(const TrieType& trie, size_t memory_budget_bytes)
+                    : m_trie_(trie), m_n_sets_(1) {
+                while (m_n_sets_ * 2 * sizeof(Set) <= memory_budget_bytes) {
+                    m_n_sets_ *= 2;
+                }
+                void* ptr = nullptr;
+                if (posix_memalign(&ptr, sizeof(Set), m_n_sets_ * sizeof(Set))) {
+                    throw std::bad_alloc();
+                }
+                m_sets_ = static_cast<Set*>(ptr);
+                for (size_t i = 0; i < m_n_sets_; ++i) {
+                    new (m_sets_ + i) Set();
+                }
+            }
+
+            ~HotKeyCache() {
+                free(m_sets_);
+            }
+
+            HotKeyCache(const HotKeyCache&) = delete;
+            HotKeyCache& operator=(const HotKeyCache&) = delete;
+
+            // `trie.index(key)`, from the cache if it holds `key`
+            int index(const std::string& key) const {
+                uint64_t hash = hash_key(key);
+                Set& set = m_sets_[hash & (m_n_sets_ - 1)];
+                for (size_t w = 0; w < WAYS; ++w) {
+                    uint64_t data = set.slots[w].data.load(std::memory_order_relaxed);
+                    uint64_t check = set.slots[w].check.load(std::memory_order_relaxed);
+                    if ((data & OCCUPIED) && (check ^ data) == hash) {
+                        count(true);
+                        return int(uint32_t(data));
+                    }
+                }
+                count(false);
+                int result = m_trie_.index(key);
+                uint64_t data = OCCUPIED | uint32_t(result);
+                Slot& slot = set.slots[victim(set)];
+                slot.data.store(data, std::memory_order_relaxed);
+                slot.check.store(hash ^ data, std::memory_order_relaxed);
+                return result;
+            }
+
+            // forget every key; concurrent `index()` calls stay correct
+            void clear() {
+                for (size_t i = 0; i < m_n_sets_; ++i) {
+                    for (size_t w = 0; w < WAYS; ++w) {
+                        m_sets_[i].slots[w].data.store(0, std::memory_order_relaxed);
+                        m_sets_[i].slots[w].check.store(0, std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            // hits and misses of all threads since the construction or `reset_stats()`
+            Stats stats() const {
+                Stats s;
+                for (size_t i = 0; i < STRIPES; ++i) {
+                    s.hits += m_stripes_[i].hits.load(std::memory_order_relaxed);
+                    s.misses += m_stripes_[i].misses.load(std::memory_order_relaxed);
+                }
+                return s;
+            }
+
+            void reset_stats() {
+                for (size_t i = 0; i < STRIPES; ++i) {
+                    m_stripes_[i].hits.store(0, std::memory_order_relaxed);
+                    m_stripes_[i].misses.store(0, std::memory_order_relaxed);
+                }
+            }
+
+            // number of keys the cache holds at most
+            size_t capacity() const {
+                return m_n_sets_ * WAYS;
+            }
+
+            SpaceReport space_report() const {
+                SpaceReport report;
+                report.add("sets", m_n_sets_ * sizeof(Set), true);
+                return report;
+            }
+
+            // 64-bit hash of the bytes of `key` (FNV-1a, then the splitmix64
+            // finalizer so the low bits that pick the set depend on every byte)
+            static uint64_t hash_key(const std::string& key) {
+                uint64_t h = 0xcbf29ce484222325ULL;
+                for (char c : key) {
+                    h = (h ^ uint8_t(c)) * 0x100000001b3ULL;
+                }
+                h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+                return h ^ (h >> 31);
+            }
+
+        private:
+            static const uint64_t OCCUPIED = uint64_t(1) << 32;
+            static const size_t STRIPES = 16;
+
+            struct Slot {
+                std::atomic<uint64_t> check{0};
+                std::atomic<uint64_t> data{0};
+            };
+
+            struct alignas(64) Set {
+                Slot slots[WAYS];
+            };
+            static_assert(sizeof(Set) == 64, "a set is one cache line");
+
+            struct alignas(64) Stripe {
+                std::atomic<uint64_t> hits{0};
+                std::atomic<uint64_t> misses{0};
+            };
+
+            // the free slot of the set, or a random one
+            static size_t victim(const Set& set) {
+                for (size_t w = 0; w < WAYS; ++w) {
+                    if (!(set.slots[w].data.load(std::memory_order_relaxed) & OCCUPIED)) return w;
+                }
+                return random_way();
+            }
+
+            // xorshift64 of the calling thread, seeded by its stripe
+            static size_t random_way() {
+                thread_local uint64_t state = 0x9E3779B97F4A7C15ULL * (thread_stripe() + 1);
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                return size_t(state >> 32) % WAYS;
+            }
+
+            // the stripe of the calling thread, threads are spread round robin
+            static size_t thread_stripe() {
+                static std::atomic<size_t> next_stripe{0};
+                thread_local size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+                return stripe;
+            }
+
+            void count(bool hit) const {
+                Stripe& s = m_stripes_[thread_stripe()];
+                std::atomic<uint64_t>& c = hit ? s.hits : s.misses;
+                c.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            const TrieType& m_trie_;
+            size_t m_n_sets_;
+            Set* m_sets_;
+            mutable Stripe m_stripes_[STRIPES];
+        };
+    }
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_HOT_KEY_CACHE_H
@@ -0,0 +1,410 @@
+//
+// Rank/select bit vector with the rank counters stored inside the cache
+// lines of the data, an alternative to RsBitVector for BasicBpVector.
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_INTERLEAVED_RANK_SELECT_BIT_VECTOR_H
+#define PATH_DECOMPOSITION_TRIE_INTERLEAVED_RANK_SELECT_BIT_VECTOR_H
+
+#include <limits>
+
+#include "bit_vector.h"
+
+namespace succinct {
+    //
+    // The bits are stored in 64-byte aligned lines of 8 words, a counter word
+    // followed by 7 data words:
+    //
+    //           +---------+-----+-----+-----+-----+-----+-----+-----+
+    //           | counter | w0  | w1  | w2  | w3  | w4  | w5  | w6  |   ...
+    //           +---------+-----+-----+-----+-----+-----+-----+-----+
+    //                     |<-           448 bits of data          ->|
+    //
+    //   counter bits [0, 37)   1-bits before the line
+    //                [37, 46)  1-bits in w0..w1
+    //                [46, 55)  1-bits in w0..w3
+    //                [55, 64)  1-bits in w0..w5
+    //
+    // rank reads a single line: the counter, the word before the position
+    // when it is at an odd offset, and the word of the position.
+    //
+    // select (select0) keeps the line of every `select_ones_per_hint`-th 1-bit
+    // (0-bit) and compares the counters of the lines up to the next hint, two
+    // to four at 1/2 density, the loads in parallel; the longer ranges of
+    // sparse vectors are binary searched first.
+    //
+    // The counters are 1/7 of the data, the 32-bit select hints 1/16 (RsBitVector:
+    // 1/4 and 1/8). The raw words are
+    // not contiguous, so the BP users read them through `word_at()`, and the
+    // decoding constructor copies the words into lines instead of mapping them.
+    //
+    class InterleavedRsBitVector {
+    public:
+        static const uint64_t line_words = 8;
+        static const uint64_t data_words_per_line = line_words - 1;
+        static const uint64_t bits_per_line = data_words_per_line * 64;
+        static const uint64_t select_ones_per_hint = 512;
+        static const uint64_t select_zeros_per_hint = select_ones_per_hint;
+        // the sorted ranges of lines are scanned up to this length, binary searched above
+        static const uint64_t select_scan_lines = 8;
+
+        InterleavedRsBitVector() : m_size_(0), m_num_ones_(0) {}
+
+        InterleavedRsBitVector(const std::vector<bool>& bools,
+                               bool with_select_hints = false,
+                               bool with_select0_hints = false) {
+            BitVector bv(bools);
+            build(bv.data().data(), bv.data().size(), bv.size(), with_select_hints, with_select0_hints);
+        }
+
+        InterleavedRsBitVector(BitVectorBuilder* builder,
+                               bool with_select_hints = false,
+                               bool with_select0_hints = false) {
+            BitVector bv(builder);
+            build(bv.data().data(), bv.data().size(), bv.size(), with_select_hints, with_select0_hints);
+        }
+
+        InterleavedRsBitVector(const uint64_t* raw_data,
+                               uint64_t word_size,
+                               size_t bit_size,
+                               bool with_select_hints = false,
+                               bool with_select0_hints = false) {
+            build(raw_data, word_size, bit_size, with_select_hints, with_select0_hints);
+        }
+
+        void swap(InterleavedRsBitVector& other) {
+            std::swap(m_size_, other.m_size_);
+            std::swap(m_num_ones_, other.m_num_ones_);
+            m_lines_.swap(other.m_lines_);
+            m_select_hints_.swap(other.m_select_hints_);
+            m_select0_hints_.swap(other.m_select0_hints_);
+        }
+
+        // "bits" are the data words of the lines, "line_counters" the counter words
+        SpaceReport space_report() const {
+            SpaceReport report;
+            uint64_t counter_bytes = m_lines_.bytes() / line_words;
+            report.add("bits", m_lines_.bytes() - counter_bytes, m_lines_.is_owned());
+            report.add("line_counters", counter_bytes, m_lines_.is_owned());
+            report.add("select_hints", m_select_hints_);
+            report.add("select0_hints", m_select0_hints_);
+            return report;
+        }
+
+        inline size_t size() const {
+            return m_size_;
+        }
+
+        inline uint64_t num_ones() const {
+            return m_num_ones_;
+        }
+
+        inline uint64_t num_zeros() const {
+            return size() - num_ones();
+        }
+
+        // number of 64-bit data words, (size() + 63) / 64
+        inline uint64_t word_count() const {
+            return (m_size_ + 63) / 64;
+        }
+
+        // `i`-th 64-bit data word
+        inline uint64_t word_at(uint64_t i) const {
+            return m_lines_[word_offset(i)];
+        }
+
+        // the `i`-th data word in its line, the words after it in the same
+        // line follow, not the next line.
+        inline const uint64_t* word_ptr(uint64_t i) const {
+            return m_lines_.data() + word_offset(i);
+        }
+
+        // get bit at `pos`.
+        inline bool operator[](uint64_t pos) const {
+            assert(pos < m_size_);
+            return (word_at(pos / 64) >> (pos % 64)) & 1;
+        }
+
+        // get the number of 1-bits in range [0, `pos`)
+        inline uint64_t rank(uint64_t pos) const {
+            assert(pos <= size());
+            PDT_COUNT(RANK);
+            uint64_t word = pos / 64;
+            const uint64_t* line = m_lines_.data() + word / data_words_per_line * line_words;
+            uint64_t w = word % data_words_per_line;
+            uint64_t r = (line[0] & LINE_RANK_MASK) + sub_rank(line, w);
+            uint64_t sub_left = pos % 64;
+            if (sub_left) {
+                r += util::popcount(line[1 + w] << (64 - sub_left));
+            }
+            return r;
+        }
+
+        // get the number of 0-bits in range [0, `pos`)
+        inline uint64_t rank0(uint64_t pos) const {
+            return pos - rank(pos);
+        }
+
+        // get `n`-th 1-bit's position in bits
+        // `n` starts from 0
+        inline uint64_t select(uint64_t n) const {
+            assert(n < num_ones());
+            PDT_COUNT(SELECT);
+            uint64_t begin = 0;
+            uint64_t end = num_lines();
+            if (m_select_hints_.size()) {
+                uint64_t chunk = n / select_ones_per_hint;
+                begin = m_select_hints_[chunk];
+                end = m_select_hints_[chunk + 1] + 1;
+            }
+            uint64_t l = find_line<false>(begin, end, n);
+            const uint64_t* line = m_lines_.data() + l * line_words;
+            uint64_t k = n - line_rank(l);
+
+            // sub-ranks of w0..w1, w0..w3, w0..w5 not above `k`
+            uint64_t c = line[0];
+            uint64_t pair = (pair_rank(c, 1) <= k) + (pair_rank(c, 2) <= k) + (pair_rank(c, 3) <= k);
+            uint64_t w = 2 * pair;
+            k -= pair_rank(c, pair);
+            if (w < 6) {
+                uint64_t pop = util::popcount(line[1 + w]);
+                if (k >= pop) {
+                    k -= pop;
+                    ++w;
+                }
+            }
+            return (l * data_words_per_line + w) * 64 + util::select_in_word(line[1 + w], k);
+        }
+
+        // get `n`-th 0-bit's position in bits
+        // `n` starts from 0
+        inline uint64_t select0(uint64_t n) const {
+            assert(n < num_zeros());
+            PDT_COUNT(SELECT0);
+            uint64_t begin = 0;
+            uint64_t end = num_lines();
+            if (m_select0_hints_.size()) {
+                uint64_t chunk = n / select_zeros_per_hint;
+                begin = m_select0_hints_[chunk];
+                end = m_select0_hints_[chunk + 1] + 1;
+            }
+            uint64_t l = find_line<true>(begin, end, n);
+            const uint64_t* line = m_lines_.data() + l * line_words;
+            uint64_t k = n - line_rank0(l);
+
+            uint64_t c = line[0];
+            uint64_t pair = (128 - pair_rank(c, 1) <= k) + (256 - pair_rank(c, 2) <= k) + (384 - pair_rank(c, 3) <= k);
+            uint64_t w = 2 * pair;
+            k -= 128 * pair - pair_rank(c, pair);
+            if (w < 6) {
+                uint64_t pop = 64 - util::popcount(line[1 + w]);
+                if (k >= pop) {
+                    k -= pop;
+                    ++w;
+                }
+            }
+            return (l * data_words_per_line + w) * 64 + util::select_in_word(~line[1 + w], k);
+        }
+
+        // find first 0 bit at pos <= `pos`.
+        inline uint64_t predecessor0(uint64_t pos) const {
+            assert(pos < m_size_);
+            PDT_COUNT(PREDECESSOR0);
+            uint64_t block = pos / 64;
+            uint64_t shift = 64 - pos % 64 - 1;
+            uint64_t word = ~word_at(block);
+            word = (word << shift) >> shift;
+
+            unsigned long ret;
+            while (!util::msb(word, ret)) {
+                PDT_COUNT(PREDECESSOR0_WORDS);
+                assert(block);
+                word = ~word_at(--block);
+            }
+            return block * 64 + ret;
+        }
+
+        // find first 0 bit at pos >= `pos`.
+        inline uint64_t successor0(uint64_t pos) const {
+            assert(pos < m_size_);
+            uint64_t block = pos / 64;
+            uint64_t shift = pos % 64;
+            uint64_t word = (~word_at(block) >> shift) << shift;
+            PDT_COUNT(SUCCESSOR0);
+
+            unsigned long ret;
+            while (!util::lsb(word, ret)) {
+                PDT_COUNT(SUCCESSOR0_WORDS);
+                ++block;
+                assert(block < word_count());
+                word = ~word_at(block);
+            }
+            return block * 64 + ret;
+        }
+
+        // find first 1 bit at pos <= `pos`.
+        inline uint64_t predecessor1(uint64_t pos) const {
+            assert(pos < m_size_);
+            uint64_t block = pos / 64;
+            uint64_t shift = 64 - pos % 64 - 1;
+            uint64_t word = word_at(block);
+            word = (word << shift) >> shift;
+
+            unsigned long ret;
+            while (!util::msb(word, ret)) {
+                assert(block);
+                word = word_at(--block);
+            }
+            return block * 64 + ret;
+        }
+
+        // find first 1 bit at pos >= `pos`.
+        inline uint64_t successor1(uint64_t pos) const {
+            assert(pos < m_size_);
+            uint64_t block = pos / 64;
+            uint64_t shift = pos % 64;
+            uint64_t word = (word_at(block) >> shift) << shift;
+
+            unsigned long ret;
+            while (!util::lsb(word, ret)) {
+                ++block;
+                assert(block < word_count());
+                word = word_at(block);
+            }
+            return block * 64 + ret;
+        }
+
+    protected:
+        static const uint64_t LINE_RANK_BITS = 37;
+        static const uint64_t LINE_RANK_MASK = (1ULL << LINE_RANK_BITS) - 1;
+
+        // position of the `i`-th data word in `m_lines_`
+        static inline uint64_t word_offset(uint64_t i) {
+            return i / data_words_per_line * line_words + 1 + i % data_words_per_line;
+        }
+
+        // including the line that holds the position size() (see `build()`)
+        inline uint64_t num_lines() const {
+            return m_lines_.size() / line_words;
+        }
+
+        inline uint64_t line_rank(uint64_t l) const {
+            return m_lines_[l * line_words] & LINE_RANK_MASK;
+        }
+
+        inline uint64_t line_rank0(uint64_t l) const {
+            return l * bits_per_line - line_rank(l);
+        }
+
+        // 1-bits in the words [0, 2 * `pair`) of a line, `pair` <= 3
+        static inline uint64_t pair_rank(uint64_t counter, uint64_t pair) {
+            return pair ? (counter >> (LINE_RANK_BITS - 9 + 9 * pair)) & 0x1FF : 0;
+        }
+
+        // 1-bits in the words [0, `w`) of `line`, `w` < 7
+        static inline uint64_t sub_rank(const uint64_t* line, uint64_t w) {
+            // the word before `w` when `w` is odd (line[0] & 0 when w == 0)
+            return pair_rank(line[0], w / 2) + util::popcount(line[w] & -(w & 1));
+        }
+
+        // 1-bits before the `word`-th data word, as RsBitVector::word_rank
+        inline uint64_t word_rank(uint64_t word) const {
+            const uint64_t* line = m_lines_.data() + word / data_words_per_line * line_words;
+            return (line[0] & LINE_RANK_MASK) + sub_rank(line, word % data_words_per_line);
+        }
+
+        // last line in [begin, end) whose rank (rank0 for `Zeros`) is <= `n`
+        template <bool Zeros>
+        inline uint64_t find_line(uint64_t begin, uint64_t end, uint64_t n) const {
+            while (end - begin > select_scan_lines) {
+                uint64_t mid = begin + (end - begin) / 2;
+                if (Zeros) {
+                    PDT_COUNT(SELECT0_STEPS);
+                } else {
+                    PDT_COUNT(SELECT_STEPS);
+                }
+                if ((Zeros ? line_rank0(mid) : line_rank(mid)) <= n) {
+                    begin = mid;
+                } else {
+                    end = mid;
+                }
+            }
+            // the counters are sorted: count the ones <= `n`, the loads of the
+            // lines are independent and overlap
+            uint64_t line = begin;
+            for (uint64_t l = begin + 1; l < end; ++l) {
+                if (Zeros) {
+                    PDT_COUNT(SELECT0_STEPS);
+                } else {
+                    PDT_COUNT(SELECT_STEPS);
+                }
+                line += (Zeros ? line_rank0(l) : line_rank(l)) <= n;
+            }
+            return line;
+        }
+
+        void build(const uint64_t* words, uint64_t n_words, size_t bit_size,
+                   bool with_select_hints, bool with_select0_hints) {
+            assert(n_words == (bit_size + 63) / 64);
+            m_size_ = bit_size;
+            // one more line than needed when the last one is full, so that
+            // rank(size()) has a line to read
+            uint64_t n_lines = n_words / data_words_per_line + 1;
+            assert(n_lines <= std::numeric_limits<uint32_t>::max());
+            std::vector<uint64_t> lines(n_lines * line_words, 0);
+
+            uint64_t ones = 0;
+            std::vector<uint32_t> select_hints, select0_hints;
+            uint64_t ones_threshold = 0, zeros_threshold = 0;
+            for (uint64_t l = 0; l < n_lines; ++l) {
+                assert(ones <= LINE_RANK_MASK);
+                uint64_t counter = ones;
+                uint64_t in_line = 0;
+                for (uint64_t w = 0; w < data_words_per_line; ++w) {
+                    if (w && w % 2 == 0) counter |= in_line << (LINE_RANK_BITS - 9 + 9 * (w / 2));
+                    uint64_t i = l * data_words_per_line + w;
+                    uint64_t word = i < n_words ? words[i] : 0;
+                    if (i == n_words - 1 && bit_size % 64) {
+                        word &= (1ULL << (bit_size % 64)) - 1;
+                    }
+                    lines[l * line_words + 1 + w] = word;
+                    in_line += util::popcount(word);
+                }
+                lines[l * line_words] = counter;
+
+                // the line of every `select_ones_per_hint`-th 1-bit (0-bit)
+                uint64_t next_ones = ones + in_line;
+                while (with_select_hints && ones_threshold < next_ones) {
+                    select_hints.push_back(uint32_t(l));
+                    ones_threshold += select_ones_per_hint;
+                }
+                // the padding past size() is not counted
+                uint64_t next_zeros = std::min<uint64_t>((l + 1) * bits_per_line, bit_size) - next_ones;
+                while (with_select0_hints && zeros_threshold < next_zeros) {
+                    select0_hints.push_back(uint32_t(l));
+                    zeros_threshold += select_zeros_per_hint;
+                }
+                ones = next_ones;
+            }
+            m_num_ones_ = ones;
+
+            m_lines_.assign_aligned(lines, line_words * sizeof(uint64_t));
+            if (with_select_hints) {
+                select_hints.push_back(uint32_t(n_lines - 1));
+                m_select_hints_.steal(select_hints);
+            }
+            if (with_select0_hints) {
+                select0_hints.push_back(uint32_t(n_lines - 1));
+                m_select0_hints_.steal(select0_hints);
+            }
+        }
+
+        size_t m_size_;
+        uint64_t m_num_ones_;
+        mappable_vector<uint64_t> m_lines_;
+        mappable_vector<uint32_t> m_select_hints_;
+        mappable_vector<uint32_t> m_select0_hints_;
+    };
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_INTERLEAVED_RANK_SELECT_BIT_VECTOR_H
@@ -0,0 +1,197 @@
+//
+// Order-preserving key encoder of DefaultPathDecomposedTrie, see
+// `compacted_trie_builder(builder, encoder)`.
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_KEY_ENCODER_H
+#define PATH_DECOMPOSITION_TRIE_KEY_ENCODER_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "space_report.h"
+
+namespace succinct {
+    namespace trie {
+        //
+        // A one-byte code per interval of the key space, as the ALM
+        // dictionaries of HOPE with fixed-length codes: the intervals
+        // partition the strings by their first two bytes and are numbered in
+        // order, a key is encoded by emitting the code of the interval the
+        // rest of the key falls in and consuming the prefix all the strings
+        // of the interval share. Within an interval the rests keep their
+        // order, so the encoded keys sort as the keys and stay distinct.
+        //
+        // An interval is one of
+        //   - a bigram "cd" (d > 0): [cd, c(d+1)), consumes 2 bytes,
+        //   - the rest of the strings starting with c, between the bigrams:
+        //     consumes 1 byte,
+        //   - an escape over a run of first bytes: consumes 1 byte, which
+        //     follows the code verbatim.
+        // Every byte of the sample has intervals of its own (the most
+        // frequent ones if they do not all fit), the others are escaped;
+        // bigrams are then added by decreasing frequency in the sample while
+        // the intervals fit in the codes. A key with the bytes and bigrams
+        // of the sample shrinks up to 2x, an escaped byte takes 2.
+        //
+        class KeyEncoder {
+        public:
+            static const size_t MAX_CODES = 256;
+
+            // the identity
+            KeyEncoder() {}
+
+            // dictionary of the bytes and bigrams of `sample`, `max_codes` >= 2 intervals
+            explicit KeyEncoder(const std::vector<std::string>& sample, size_t max_codes = MAX_CODES) {
+                assert(max_codes >= 2 && max_codes <= MAX_CODES);
+                std::vector<uint64_t> byte_freq(256, 0), bigram_freq(1 << 16, 0);
+                for (auto& key : sample) {
+                    for (size_t i = 0; i < key.size(); ++i) {
+                        uint8_t c = uint8_t(key[i]);
+                        ++byte_freq[c];
+                        if (i + 1 < key.size()) ++bigram_freq[c << 8 | uint8_t(key[i + 1])];
+                    }
+                }
+
+                // the bytes with intervals of their own, the least frequent are escaped
+                std::vector<bool> own(256);
+                for (size_t c = 0; c < 256; ++c) own[c] = byte_freq[c] > 0;
+                while (intervals(own, {}).size() > max_codes) {
+                    size_t rarest = 256;
+                    for (size_t c = 0; c < 256; ++c) {
+                        if (own[c] && (rarest == 256 || byte_freq[c] < byte_freq[rarest])) rarest = c;
+                    }
+                    own[rarest] = false;
+                }
+
+                std::vector<std::pair<uint64_t, uint16_t>> candidates;     // (frequency, bigram)
+                for (size_t b = 0; b < bigram_freq.size(); ++b) {
+                    if (bigram_freq[b] > 1 && own[b >> 8] && (b & 0xFF)) candidates.emplace_back(bigram_freq[b], b);
+                }
+                std::sort(candidates.begin(), candidates.end(), std::greater<std::pair<uint64_t, uint16_t>>());
+                std::set<uint16_t> bigrams;
+                size_t n_intervals = intervals(own, bigrams).size();
+                for (auto& cand : candidates) {
+                    bigrams.insert(cand.second);
+                    size_t n = intervals(own, bigrams).size();
+                    if (n > max_codes) {
+                        bigrams.erase(cand.second);
+                    } else {
+                        n_intervals = n;
+                    }
+                    if (n_intervals == max_codes) break;
+                }
+                build_intervals(own, bigrams);
+                assert(m_bounds_.size() == n_intervals);
+            }
+
+            bool empty() const {
+                return m_bounds_.empty();
+            }
+
+            size_t num_codes() const {
+                return m_bounds_.size();
+            }
+
+            // append the code of `key[0, n)` to `out`, a vector of uint8_t
+            // or of the uint16_t labels
+            template <typename Out>
+            void encode(const uint8_t* key, size_t n, Out& out) const {
+                size_t i = 0;
+                while (i < n) {
+                    // a last byte c sorts as c0, the rest of c
+                    uint16_t v = uint16_t(key[i] << 8 | (i + 1 < n ? key[i + 1] : 0));
+                    // from the interval of c0, the bigrams of c are few
+                    size_t code = m_first_[key[i]];
+                    while (code + 1 < m_bounds_.size() && m_bounds_[code + 1] <= v) ++code;
+                    out.push_back(uint8_t(code));
+                    if (!m_consumed_[code]) out.push_back(key[i]);
+                    i += m_consumed_[code] ? m_consumed_[code] : 1;
+                }
+            }
+
+            std::string encode(const std::string& key) const {
+                std::vector<uint8_t> out;
+                encode(reinterpret_cast<const uint8_t*>(key.data()), key.size(), out);
+                return std::string(out.begin(), out.end());
+            }
+
+            // append the key of `code[0, n)` to `out`
+            void decode(const uint8_t* code, size_t n, std::vector<uint8_t>& out) const {
+                for (size_t i = 0; i < n; ++i) {
+                    uint8_t c = code[i];
+                    assert(c < m_bounds_.size());
+                    switch (m_consumed_[c]) {
+                        case 0:
+                            assert(i + 1 < n);
+                            out.push_back(code[++i]);
+                            break;
+                        case 1:
+                            out.push_back(uint8_t(m_bounds_[c] >> 8));
+                            break;
+                        default:
+                            out.push_back(uint8_t(m_bounds_[c] >> 8));
+                            out.push_back(uint8_t(m_bounds_[c]));
+                    }
+                }
+            }
+
+            SpaceReport space_report() const {
+                SpaceReport report;
+                report.add("bounds", m_bounds_.size() * sizeof(uint16_t), true);
+                report.add("consumed", m_consumed_.size(), true);
+                report.add("first", sizeof(m_first_), true);
+                return report;
+            }
+
+        private:
+            // the intervals of `own` bytes and `bigrams` (as c << 8 | d), in
+            // order: (lower bound, bytes consumed)
+            static std::vector<std::pair<uint16_t, uint8_t>> intervals(const std::vector<bool>& own,
+                                                                         const std::set<uint16_t>& bigrams) {
+                std::vector<std::pair<uint16_t, uint8_t>> result;
+                auto bigram = bigrams.begin();
+                for (size_t c = 0; c < 256; ++c) {
+                    uint16_t lower = uint16_t(c << 8);
+                    if (!own[c]) {
+                        if (result.empty() || result.back().second) result.emplace_back(lower, 0);
+                        continue;
+                    }
+                    result.emplace_back(lower, 1);      // c itself and the strings before the first bigram
+                    for (; bigram != bigrams.end() && *bigram >> 8 == c; ++bigram) {
+                        // no gap between two consecutive bigrams
+                        if (result.back().first == *bigram) result.pop_back();
+                        result.emplace_back(*bigram, 2);
+                        if ((*bigram & 0xFF) != 0xFF) result.emplace_back(*bigram + 1, 1);
+                    }
+                }
+                return result;
+            }
+
+            void build_intervals(const std::vector<bool>& own, const std::set<uint16_t>& bigrams) {
+                m_bounds_.clear();
+                m_consumed_.clear();
+                for (auto& iv : intervals(own, bigrams)) {
+                    m_bounds_.push_back(iv.first);
+                    m_consumed_.push_back(iv.second);
+                }
+                for (size_t c = 0, code = 0; c < 256; ++c) {
+                    while (code + 1 < m_bounds_.size() && m_bounds_[code + 1] <= c << 8) ++code;
+                    m_first_[c] = uint8_t(code);
+                }
+            }
+
+            std::vector<uint16_t> m_bounds_;        // lower bound of each interval, as c << 8 | d
+            std::vector<uint8_t> m_consumed_;       // bytes consumed by each interval, 0 for an escape
+            uint8_t m_first_[256] = {};             // the interval of c0 for each byte c
+        };
+    }
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_KEY_ENCODER_H
@@ -5,7 +5,13 @@
 #ifndef PATH_DECOMPOSITION_TRIE_MAPPABLE_VECTOR_H
 #define PATH_DECOMPOSITION_TRIE_MAPPABLE_VECTOR_H
 
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <functional>
+#include <new>
+#include <vector>
 
 namespace succinct {
     typedef std::function<void()> deleter_t;
@@ -63,12 +69,15 @@ namespace succinct {
             mappable_vector().swap(*this);
         }
 
+        // take the storage of `vec`, its capacity slack released so that
+        // `bytes()` is the memory held
         void steal(std::vector<T>& vec) {
             clear();
             m_size = vec.size();
             if (m_size) {
                 std::vector<T>* new_vec = new std::vector<T>;
                 new_vec->swap(vec);
+                new_vec->shrink_to_fit();
                 m_deleter = [new_vec] {
                     delete new_vec;
                 };
@@ -81,6 +90,24 @@ namespace succinct {
             mappable_vector(from).swap(*this);
         }
 
+        // copy of `from` starting on an `alignment`-byte boundary, a power of
+        // two multiple of sizeof(void*), e.g. a cache line
+        void assign_aligned(const std::vector<T>& from, size_t alignment) {
+            clear();
+            if (from.empty()) return;
+            void* ptr = nullptr;
+            if (posix_memalign(&ptr, alignment, from.size() * sizeof(T))) {
+                throw std::bad_alloc();
+            }
+            T* data = static_cast<T*>(ptr);
+            std::copy(std::begin(from), std::end(from), data);
+            m_deleter = [data] {
+                free(data);
+            };
+            m_data = data;
+            m_size = from.size();
+        }
+
         uint64_t size() const {
             return m_size;
         }
@@ -106,6 +133,15 @@ namespace succinct {
             return (*this)[m_size - 1];
         }
 
+        uint64_t bytes() const {
+            return m_size * sizeof(T);
+        }
+
+        // false if the data is mapped on a buffer the vector does not own
+        bool is_owned() const {
+            return static_cast<bool>(m_deleter);
+        }
+
 //        inline void prefetch(size_t i) const {
 //            succinct::intrinsics::prefetch(m_data + i);
 //        }
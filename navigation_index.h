@@ -0,0 +1,51 @@
+//
+// Opt-in navigation arrays of DefaultPathDecomposedTrie, see
+// `build_navigation_index()`.
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_NAVIGATION_INDEX_H
+#define PATH_DECOMPOSITION_TRIE_NAVIGATION_INDEX_H
+
+#include "compact_vector.h"
+
+namespace succinct {
+    namespace trie {
+        //
+        // The branches of the nodes are numbered in BP order, the branches of
+        // node `v` are `[first_branch[v], first_branch[v + 1])` and the node
+        // reached by the branch `b` is `child[b]`. An `index()` hop then reads
+        // these two arrays instead of select0 / rank / predecessor0 to find the
+        // branches and find_close / successor0 / rank0 to find the child.
+        //
+        // Both are bit packed: (nodes + 1) * log(branches) + branches * log(nodes) bits.
+        //
+        struct NavigationIndex {
+            CompactVector first_branch;
+            CompactVector child;
+
+            bool empty() const {
+                return first_branch.empty();
+            }
+
+            void swap(NavigationIndex& other) {
+                first_branch.swap(other.first_branch);
+                child.swap(other.child);
+            }
+
+            // the branches of `node` are [begin, end)
+            inline void branch_range(size_t node, size_t& begin, size_t& end) const {
+                begin = first_branch[node];
+                end = first_branch[node + 1];
+            }
+
+            SpaceReport space_report() const {
+                SpaceReport report;
+                report.add("first_branch", first_branch.bytes(), first_branch.is_owned());
+                report.add("child", child.bytes(), child.is_owned());
+                return report;
+            }
+        };
+    }
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_NAVIGATION_INDEX_H
@@ -5,31 +5,58 @@
 #ifndef PATH_DECOMPOSITION_TRIE_PATH_DECOMPOSED_TRIE_H
 #define PATH_DECOMPOSITION_TRIE_PATH_DECOMPOSED_TRIE_H
 
+#include <stdexcept>
 #include "compacted_trie_builder.h"
 #include "default_tree_builder.h"
 #include "balanced_parentheses_vector.h"
+#include "branch_search.h"
+#include "key_encoder.h"
+#include "navigation_index.h"
+#include "permutation.h"
+#include "repair_labels.h"
+#include "tail_pool.h"
+#include "top_level_table.h"
+#include "trie_trace.h"
 
 namespace succinct {
     namespace trie {
+        // how the labels are stored, see `separate_tails()` and `compress_labels()`
+        enum class LabelEncoding {
+            RAW,
+            REPAIR,
+            TAIL,
+            TAIL_REPAIR
+        };
+
         // false - CENTROID, true - LEX
-        template<bool Lexicographic = false>
+        // `BpVectorType`: BpVector, or e.g. BasicBpVector<InterleavedRsBitVector>
+        // (one of the configurations instantiated in balanced_parentheses_vector.cpp)
+        template<bool Lexicographic = false, typename BpVectorType = BpVector>
         struct DefaultPathDecomposedTrie {
             mappable_vector<uint16_t> m_labels;      // `L` in paper
             mappable_vector<uint16_t> m_branches;     // `B` in paper
-            BpVector m_bp;                       // `BP` in paper
+            BpVectorType m_bp;                       // `BP` in paper
             // TODO: Use elias-fano encoding later.
             mappable_vector<uint64_t> word_positions;
+            NavigationIndex m_nav;                   // empty unless build_navigation_index()
+            TopLevelTable m_top;                     // empty unless build_top_level_table()
+            RePairLabels m_repair_labels;            // empty unless compress_labels(), which empties m_labels
+            TailPool m_tails;                        // empty unless separate_tails()
+            KeyEncoder m_key_encoder;                // empty unless the builder had one
+            Permutation m_ranks;                     // empty unless build_rank_index(), centroid only
 
             DefaultPathDecomposedTrie(compacted_trie_builder
-                                      <DefaultTreeBuilder<Lexicographic>> &trieBuilder) {
+                                      <DefaultTreeBuilder<Lexicographic>> &trieBuilder,
+                                      LabelEncoding label_encoding = LabelEncoding::RAW) {
                 assert(trieBuilder.is_finish());
+                if (trieBuilder.key_encoder()) m_key_encoder = *trieBuilder.key_encoder();
 
                 typename DefaultTreeBuilder<Lexicographic>::representation_type
                         root = trieBuilder.get_root();
                 m_labels.steal(root->m_labels);
                 m_branches.steal(root->m_branches);
                 // [double free error] m_bp = BpVector(&root->m_bp, false, true);(fxxk c++!!!!)
-                auto tmp = BpVector(&root->m_bp, false, true);
+                auto tmp = BpVectorType(&root->m_bp, false, true);
                 m_bp.swap(tmp);
 
                 assert(m_labels.back() == DefaultTreeBuilder<Lexicographic>::DELIMITER_FLAG);
@@ -45,9 +72,16 @@ namespace succinct {
                 }
                 tmp_vec.push_back(static_cast<uint64_t>(m_labels.size()));
                 word_positions.steal(tmp_vec);
+                if (label_encoding == LabelEncoding::TAIL || label_encoding == LabelEncoding::TAIL_REPAIR) {
+                    separate_tails();
+                }
+                if (label_encoding == LabelEncoding::REPAIR || label_encoding == LabelEncoding::TAIL_REPAIR) {
+                    compress_labels();
+                }
             }
 
-            // The constructor is used for decoding.
+            // The constructor is used for decoding the raw encoding:
+            // `get_labels()`, `get_branches()`, `get_bp()` and `word_positions`.
             DefaultPathDecomposedTrie(const uint16_t* label_ptr, uint64_t label_len,
                                       const uint16_t* branch_ptr, uint64_t branch_len,
                                       const uint64_t* raw_data, uint64_t word_size, size_t bit_size,
@@ -57,7 +91,22 @@ namespace succinct {
                                       , m_bp(raw_data, word_size, bit_size, false, true)
                                       , word_positions(pos_ptr, pos_len) {}
 
+            // The labels of the raw encoding. A trie with compressed labels
+            // has none, one with separated tails lacks the tail bytes and
+            // their WORD_EOF, one with a key encoder holds the encoded keys,
+            // and the decoding constructor could restore neither the
+            // RePairLabels, the TailPool nor the KeyEncoder: throws
+            // std::runtime_error for these tries.
             const mappable_vector<uint16_t> &get_labels() const {
+                if (has_compressed_labels()) {
+                    throw std::runtime_error("a trie with compressed labels has no raw encoding");
+                }
+                if (has_tails()) {
+                    throw std::runtime_error("a trie with separated tails has no raw encoding");
+                }
+                if (!m_key_encoder.empty()) {
+                    throw std::runtime_error("a trie with a key encoder has no raw encoding");
+                }
                 return m_labels;
             }
 
@@ -66,15 +115,234 @@ namespace succinct {
             }
 
             // TODO: return a const reference OK?
-            const BpVector& get_bp() const {
+            const BpVectorType& get_bp() const {
                 return m_bp;
             }
 
+            // number of labels + branches + BP bits, see `space_report()` for bytes
             size_t size() const {
-                return m_labels.size() + m_branches.size() + m_bp.size();
+                return label_count() + m_branches.size() + m_bp.size();
+            }
+
+            // number of labels, raw or compressed, without the tails
+            size_t label_count() const {
+                return static_cast<size_t>(word_positions.back());
+            }
+
+            // bytes of every array, the BP ones prefixed with "bp."
+            SpaceReport space_report() const {
+                SpaceReport report;
+                report.add("labels", m_labels);
+                if (!m_repair_labels.empty()) {
+                    report.add("repair_labels", m_repair_labels.space_report());
+                }
+                if (!m_tails.empty()) {
+                    report.add("tails", m_tails.space_report());
+                }
+                report.add("branches", m_branches);
+                report.add("word_positions", word_positions);
+                report.add("bp", m_bp.space_report());
+                if (!m_nav.empty()) {
+                    report.add("navigation", m_nav.space_report());
+                }
+                if (!m_top.empty()) {
+                    report.add("top_level", m_top.space_report());
+                }
+                if (!m_key_encoder.empty()) {
+                    report.add("key_encoder", m_key_encoder.space_report());
+                }
+                if (!m_ranks.empty()) {
+                    report.add("ranks", m_ranks.space_report());
+                }
+                return report;
+            }
+
+            // Build the navigation arrays (navigation_index.h) of the trie,
+            // `index()` then reads them instead of the BP operations. Opt-in:
+            // they are a few times the BP bytes, reported as "navigation.*".
+            void build_navigation_index() {
+                size_t n_nodes = word_positions.size() - 1;
+                std::vector<uint64_t> first_branch, child;
+                first_branch.reserve(n_nodes + 1);
+                size_t next_branch = 0;
+                for (size_t node_idx = 0; node_idx < n_nodes; ++node_idx) {
+                    size_t end, num;
+                    get_branch_idx_by_node_idx(node_idx, end, num);
+                    assert(end + 1 - num == next_branch);
+                    first_branch.push_back(next_branch);
+                    size_t node_bp_idx = m_bp.select0(node_idx);
+                    for (size_t i = 0; i < num; ++i) {
+                        child.push_back(get_node_idx_by_branch_idx(node_bp_idx - num + i));
+                    }
+                    next_branch += num;
+                }
+                first_branch.push_back(next_branch);
+
+                CompactVector first_branch_vec(first_branch);
+                CompactVector child_vec(child);
+                m_nav.first_branch.swap(first_branch_vec);
+                m_nav.child.swap(child_vec);
+            }
+
+            void clear_navigation_index() {
+                NavigationIndex().swap(m_nav);
+            }
+
+            bool has_navigation_index() const {
+                return !m_nav.empty();
+            }
+
+            // Store the position in the sorted key set of the key of every
+            // node as a Permutation (permutation.h) with an inverse sampled
+            // every `inverse_step` links, reported as "ranks.*", for `rank()`
+            // and the ordered operations. The lexicographic decomposition
+            // numbers the nodes in key order, it stores nothing. Decodes and
+            // sorts all the keys once.
+            void build_rank_index(size_t inverse_step = Permutation::DEFAULT_STEP) {
+                if (Lexicographic || !m_ranks.empty()) return;
+                size_t n_nodes = word_positions.size() - 1;
+                std::vector<std::vector<uint8_t>> keys(n_nodes);
+                for (size_t node = 0; node < n_nodes; ++node) keys[node] = (*this)[node];
+                std::vector<uint64_t> order(n_nodes);
+                for (size_t node = 0; node < n_nodes; ++node) order[node] = node;
+                // vector<uint8_t> compares unsigned bytes, as the builder
+                std::sort(order.begin(), order.end(), [&](uint64_t a, uint64_t b) { return keys[a] < keys[b]; });
+                std::vector<uint64_t> ranks(n_nodes);
+                for (size_t r = 0; r < n_nodes; ++r) ranks[order[r]] = r;
+                Permutation ranks_perm(ranks, inverse_step);
+                m_ranks.swap(ranks_perm);
+            }
+
+            void clear_rank_index() {
+                Permutation().swap(m_ranks);
+            }
+
+            // `rank()` and the ordered operations can be called
+            bool has_rank_index() const {
+                return Lexicographic || !m_ranks.empty();
+            }
+
+            // Move the tail of every node, the bytes after its last branching
+            // point, from the labels to a suffix-merged pool (tail_pool.h),
+            // reported as "tails.*": `index()` walks denser labels and
+            // compares the tail once it reaches the node's delimiter.
+            // On the raw labels, before `compress_labels()`; the top-level
+            // table is cleared, its label positions change.
+            void separate_tails() {
+                assert(m_repair_labels.empty());
+                if (!m_tails.empty()) return;
+                typedef DefaultTreeBuilder<Lexicographic> builder_t;
+                size_t n_nodes = word_positions.size() - 1;
+                std::vector<std::string> tails(n_nodes);
+                std::vector<uint16_t> heads;
+                std::vector<uint64_t> positions;
+                heads.reserve(m_labels.size());
+                for (size_t node = 0; node < n_nodes; ++node) {
+                    size_t first = static_cast<size_t>(word_positions[node]);
+                    size_t end = static_cast<size_t>(word_positions[node + 1]) - 1;    // the delimiter
+                    size_t tail_begin = first;
+                    for (size_t i = first; i < end; ++i) {
+                        if (m_labels[i] >> 8 == 1) tail_begin = ++i + 1;
+                    }
+                    // bytes then WORD_EOF, at least one byte
+                    bool is_tail = end >= tail_begin + 2 && m_labels[end - 1] == builder_t::WORD_EOF;
+                    for (size_t i = tail_begin; is_tail && i + 1 < end; ++i) {
+                        is_tail = m_labels[i] < 256;
+                    }
+                    size_t head_end = is_tail ? tail_begin : end;
+                    positions.push_back(heads.size());
+                    heads.insert(heads.end(), m_labels.data() + first, m_labels.data() + head_end);
+                    heads.push_back(builder_t::DELIMITER_FLAG);
+                    for (size_t i = head_end; is_tail && i + 1 < end; ++i) {
+                        tails[node].push_back(char(m_labels[i]));
+                    }
+                }
+                positions.push_back(heads.size());
+
+                TailPool pool(tails);
+                m_tails.swap(pool);
+                m_labels.steal(heads);
+                word_positions.steal(positions);
+                clear_top_level_table();
+            }
+
+            bool has_tails() const {
+                return !m_tails.empty();
+            }
+
+            // Replace the raw labels by their Re-Pair grammar (repair_labels.h),
+            // reported as "repair_labels.*". `index()` and `operator[]` then
+            // expand the symbols of the nodes they visit; `get_labels()` is
+            // empty, TrieStats::collect() and the raw encoding need the raw
+            // labels.
+            void compress_labels() {
+                if (!m_repair_labels.empty()) return;
+                RePairLabels labels(m_labels.data(), m_labels.size(),
+                                    DefaultTreeBuilder<Lexicographic>::DELIMITER_FLAG);
+                m_repair_labels.swap(labels);
+                m_labels.clear();
+            }
+
+            bool has_compressed_labels() const {
+                return !m_repair_labels.empty();
+            }
+
+            // Build the top-level table (top_level_table.h) of the longest key
+            // prefix, up to 3 bytes, whose table fits in `memory_budget_bytes`:
+            // `index()` of a key at least that long then starts from the state
+            // stored for its prefix. Reported as "top_level.*". Returns the
+            // prefix length, 0 (no table) if the budget is below 3KB.
+            size_t build_top_level_table(size_t memory_budget_bytes) {
+                TopLevelTable table;
+                table.prefix_len = TopLevelTable::prefix_len_for(memory_budget_bytes);
+                // the states are stored in 32 bits
+                if (label_count() >= TopLevelTable::MISS || m_branches.size() >= TopLevelTable::MISS) {
+                    table.prefix_len = 0;
+                }
+                if (table.prefix_len) {
+                    size_t n_slots = size_t(1) << (8 * table.prefix_len);
+                    std::vector<uint32_t> nodes(n_slots), labels(n_slots), branches(n_slots);
+                    std::vector<uint16_t> prefix(table.prefix_len);
+                    NullTracer tracer;
+                    for (size_t slot = 0; slot < n_slots; ++slot) {
+                        for (size_t i = 0; i < table.prefix_len; ++i) {
+                            prefix[i] = uint16_t(slot >> (8 * (table.prefix_len - 1 - i)) & 0xFF);
+                        }
+                        IndexState state;
+                        int result = -1;
+                        if (match(prefix.data(), prefix.size(), prefix.size(), state, result, tracer)) {
+                            nodes[slot] = uint32_t(state.node_idx);
+                            labels[slot] = uint32_t(state.label_idx);
+                            branches[slot] = uint32_t(state.branch_idx);
+                        } else if (result == STOPPED_IN_TAIL) {
+                            nodes[slot] = TopLevelTable::FROM_ROOT;
+                        } else {
+                            nodes[slot] = TopLevelTable::MISS;
+                        }
+                    }
+                    table.nodes.steal(nodes);
+                    table.labels.steal(labels);
+                    table.branches.steal(branches);
+                }
+                m_top.swap(table);
+                return m_top.prefix_len;
+            }
+
+            void clear_top_level_table() {
+                TopLevelTable().swap(m_top);
+            }
+
+            bool has_top_level_table() const {
+                return !m_top.empty();
             }
 
             void get_branch_idx_by_node_idx(size_t node_idx, size_t& end, size_t& num) const {
+                NullTracer tracer;
+                get_branch_idx_by_node_idx(node_idx, end, num, tracer);
+            }
+
+            template <typename Tracer>
+            void get_branch_idx_by_node_idx(size_t node_idx, size_t& end, size_t& num, Tracer& tracer) const {
                 size_t bp_idx = m_bp.select0(node_idx);
                 assert(m_bp.rank(bp_idx) >= 2);
                 end = m_bp.rank(bp_idx) - 2;
@@ -82,14 +350,27 @@ namespace succinct {
                     num = end + 1;
                     return;
                 }
-                num = bp_idx - m_bp.predecessor0(bp_idx - 1) - 1;
+                size_t prev = m_bp.predecessor0(bp_idx - 1);
+                tracer.bp(prev, bp_word(prev));
+                num = bp_idx - prev - 1;
                 return;
             }
 
             // `branch_idx` for `m_bp`
             size_t get_node_idx_by_branch_idx(size_t branch_idx) const {
+                NullTracer tracer;
+                return get_node_idx_by_branch_idx(branch_idx, tracer);
+            }
+
+            template <typename Tracer>
+            size_t get_node_idx_by_branch_idx(size_t branch_idx, Tracer& tracer) const {
                 assert(branch_idx != 0 && m_bp[branch_idx]);
-                return m_bp.rank0(m_bp.successor0(m_bp.find_close(branch_idx) + 1));
+                tracer.bp(branch_idx, bp_word(branch_idx));
+                size_t close = m_bp.find_close(branch_idx);
+                tracer.bp(close, bp_word(close));
+                size_t node_bp_idx = m_bp.successor0(close + 1);
+                tracer.bp(node_bp_idx, bp_word(node_bp_idx));
+                return m_bp.rank0(node_bp_idx);
             }
 
             bool get_parent_node_branch_by_node_idx(
@@ -111,30 +392,411 @@ namespace succinct {
             // In rocksdb, we will not use string any more, maybe InternalKey...
             // get the index of `val` in the string set, if not exists return -1.
             int index(const std::string &s) const {
-                std::vector<uint16_t> val(s.begin(), s.end());
+                NullTracer tracer;
+                return index_impl(s, tracer);
+            }
+
+            // The position of `s` in the sorted key set, a dense id in [0, n)
+            // for the keys of the set; -1 if absent. The centroid
+            // decomposition needs `build_rank_index()`.
+            int rank(const std::string &s) const {
+                assert(has_rank_index());
+                int idx = index(s);
+                if (Lexicographic || idx < 0) return idx;
+                return int(m_ranks[idx]);
+            }
+
+            // Ordered operations on the ranks of `rank()`, the centroid
+            // decomposition needs `build_rank_index()`.
+
+            size_t num_keys() const {
+                return word_positions.size() - 1;
+            }
+
+            size_t rank_of_node(size_t node_idx) const {
+                return Lexicographic ? node_idx : size_t(m_ranks[node_idx]);
+            }
+
+            // follows the sampled inverse in the centroid decomposition
+            size_t node_of_rank(size_t rank) const {
+                return Lexicographic ? rank : size_t(m_ranks.inverse(rank));
+            }
+
+            // the key of rank `rank`
+            std::vector<uint8_t> select(size_t rank) const {
+                return (*this)[node_of_rank(rank)];
+            }
+
+            // The rank of the first key not less than `s`, `num_keys()` if
+            // there is none. The lookup of `s` runs until it leaves the
+            // trie; the answer is then the smallest (or past the largest) key
+            // below the point where it left, reached by following the
+            // smallest (largest) symbol at every branching point.
+            size_t lower_bound(const std::string &s) const {
+                assert(has_rank_index());
+                if (!num_keys()) return 0;
+                std::vector<uint16_t> val;
+                key_symbols(s, val);
+                if (m_repair_labels.empty()) {
+                    RawLabelReader labels{m_labels.data()};
+                    return lower_bound_labels(val, labels);
+                }
+                RePairLabels::Reader labels(m_repair_labels, word_positions.data());
+                return lower_bound_labels(val, labels);
+            }
+
+            // the ranks [first, second) of the keys starting with `prefix`
+            std::pair<size_t, size_t> prefix_range(const std::string &prefix) const {
+                size_t first = lower_bound(prefix);
+                // the smallest string above all the ones starting with `prefix`
+                std::string next = prefix;
+                while (!next.empty() && uint8_t(next.back()) == 0xFF) next.pop_back();
+                if (next.empty()) return std::make_pair(first, num_keys());
+                next.back() = char(uint8_t(next.back()) + 1);
+                return std::make_pair(first, lower_bound(next));
+            }
+
+            size_t prefix_count(const std::string &prefix) const {
+                std::pair<size_t, size_t> range = prefix_range(prefix);
+                return range.second - range.first;
+            }
+
+            // `index` recording the nodes, labels, branch scans and BP positions
+            // visited into `trace`, see trie_trace.h.
+            int index_traced(const std::string &s, Trace& trace) const {
+                trace.clear();
+                trace.result = index_impl(s, trace);
+                return trace.result;
+            }
+
+            // `index()` of the `n` keys into `out`. A key resumes from the
+            // deepest node the previous key entered on their common prefix
+            // instead of the root: for sorted keys the hops of the shared
+            // prefixes are done once. Any order gives the same results.
+            // The top-level table is not used.
+            void index_sorted_batch(const std::string* keys, size_t n, int* out) const {
+                NodePathTracer path;
+                std::vector<uint16_t> val, prev;
+                for (size_t i = 0; i < n; ++i) {
+                    val.swap(prev);
+                    key_symbols(keys[i], val);
+                    PDT_COUNT(TRIE_INDEX);
+                    size_t lcp = 0;
+                    if (i) {
+                        // without the WORD_EOF
+                        size_t max_lcp = std::min(prev.size(), val.size()) - 1;
+                        while (lcp < max_lcp && prev[lcp] == val[lcp]) ++lcp;
+                    }
+                    // the path to a node only depends on the bytes matched before it
+                    while (!path.nodes.empty() && path.nodes.back().second > lcp) {
+                        path.nodes.pop_back();
+                    }
+                    IndexState state;
+                    if (!path.nodes.empty()) {
+                        state.node_idx = path.nodes.back().first;
+                        state.matching_idx = path.nodes.back().second;
+                        path.nodes.pop_back();      // entered again by `match()`
+                    }
+                    int result = -1;
+                    match(val.data(), val.size(), size_t(-1), state, result, path);
+                    out[i] = result;
+                }
+            }
+
+            std::vector<int> index_sorted_batch(const std::vector<std::string>& keys) const {
+                std::vector<int> out(keys.size());
+                index_sorted_batch(keys.data(), keys.size(), out.data());
+                return out;
+            }
+
+            // the symbols `index()` matches for `s` into `val`: its bytes,
+            // through the key encoder if any, then WORD_EOF
+            void key_symbols(const std::string &s, std::vector<uint16_t>& val) const {
+                // go through uint8_t, `char` may be signed
+                const uint8_t* bytes = reinterpret_cast<const uint8_t*>(s.data());
+                if (m_key_encoder.empty()) {
+                    val.assign(bytes, bytes + s.size());
+                } else {
+                    val.clear();
+                    m_key_encoder.encode(bytes, s.size(), val);
+                }
                 val.push_back(DefaultTreeBuilder<Lexicographic>::WORD_EOF);
-                size_t len = val.size();
-                size_t cur_node_idx = 0;
+            }
+
+            template <typename Tracer>
+            int index_impl(const std::string &s, Tracer& tracer) const {
+                std::vector<uint16_t> val;
+                key_symbols(s, val);
+                PDT_COUNT(TRIE_INDEX);
+                IndexState state;
+                if (m_top.covers(val.size() - 1)) {
+                    tracer.touch(m_top.nodes.data() + m_top.slot(val.data()));
+                    if (!m_top.lookup(val.data(), state)) return -1;
+                }
+                int result = -1;
+                match(val.data(), val.size(), size_t(-1), state, result, tracer);
+                return result;
+            }
+
+            // Match `val[state.matching_idx, len)` from `state`. Returns false
+            // with `result` set (the node index or -1) when the match ends, or
+            // true with `state` set once `stop` symbols of `val` are matched
+            // (`result` is STOPPED_IN_TAIL if they end in a tail).
+            static const int STOPPED_IN_TAIL = -2;
+
+            template <typename Tracer>
+            bool match(const uint16_t* val, size_t len, size_t stop,
+                       IndexState& state, int& result, Tracer& tracer) const {
+                if (m_repair_labels.empty()) {
+                    RawLabelReader labels{m_labels.data()};
+                    return match_labels(val, len, stop, state, result, tracer, labels);
+                }
+                RePairLabels::Reader labels(m_repair_labels, word_positions.data());
+                return match_labels(val, len, stop, state, result, tracer, labels);
+            }
+
+            // the labels of the raw `m_labels`, with the interface of RePairLabels::Reader
+            struct RawLabelReader {
+                const uint16_t* labels;
+
+                inline void seek_node(size_t) {}
+
+                inline uint16_t operator[](size_t i) const {
+                    return labels[i];
+                }
+
+                inline const uint16_t* ptr(size_t i) const {
+                    return labels + i;
+                }
+            };
+
+            // the symbols in key order: a key is smaller than its extensions
+            static inline int symbol_order(uint16_t symbol) {
+                return symbol == DefaultTreeBuilder<Lexicographic>::WORD_EOF ? -1 : int(symbol);
+            }
+
+            // the branches of a node for the ordered operations
+            struct NodeBranches {
+                size_t first;       // first branch of the node
+                size_t end;         // last branch of the node + 1
+                size_t bp_idx;      // position of the node's ")" in BP, -1 with the navigation index
+            };
+
+            NodeBranches node_branches(size_t node_idx) const {
+                NodeBranches nb;
+                if (!m_nav.empty()) {
+                    m_nav.branch_range(node_idx, nb.first, nb.end);
+                    nb.bp_idx = size_t(-1);
+                } else {
+                    size_t last, num;
+                    get_branch_idx_by_node_idx(node_idx, last, num);
+                    nb.first = last + 1 - num;
+                    nb.end = last + 1;
+                    nb.bp_idx = m_bp.select0(node_idx);
+                }
+                return nb;
+            }
+
+            size_t child_node(const NodeBranches& nb, size_t branch_idx) const {
+                if (!m_nav.empty()) return m_nav.child[branch_idx];
+                return get_node_idx_by_branch_idx(nb.bp_idx + branch_idx - nb.end);
+            }
+
+            // the smallest (`Largest` false) or largest key below label
+            // `label_idx` of `node_idx`, `branch_idx` the branch of its next
+            // branching point: the rank of its node
+            template <bool Largest, typename LabelReader>
+            size_t extreme_rank(size_t node_idx, size_t label_idx, size_t branch_idx, LabelReader& labels) const {
+                NodeBranches nb = node_branches(node_idx);
+                while (true) {
+                    uint16_t label = labels[label_idx];
+                    if (label == DefaultTreeBuilder<Lexicographic>::DELIMITER_FLAG) return rank_of_node(node_idx);
+                    if (label >> 8 != 1) {
+                        ++label_idx;
+                        continue;
+                    }
+                    size_t n_light = static_cast<uint8_t>(label) + 1;
+                    int heavy = symbol_order(labels[label_idx + 1]);
+                    // the light branch beyond the heavy symbol the farthest
+                    size_t best = n_light;
+                    for (size_t j = 0; j < n_light; ++j) {
+                        int o = symbol_order(m_branches[branch_idx + j]);
+                        int best_o = best < n_light ? symbol_order(m_branches[branch_idx + best]) : heavy;
+                        if (Largest ? o > best_o : o < best_o) best = j;
+                    }
+                    if (best == n_light) {
+                        label_idx += 2;
+                        branch_idx += n_light;
+                        continue;
+                    }
+                    node_idx = child_node(nb, branch_idx + best);
+                    nb = node_branches(node_idx);
+                    labels.seek_node(node_idx);
+                    label_idx = static_cast<size_t>(word_positions[node_idx]);
+                    branch_idx = nb.first;
+                }
+            }
+
+            template <typename LabelReader>
+            size_t lower_bound_labels(const std::vector<uint16_t>& val, LabelReader& labels) const {
+                typedef DefaultTreeBuilder<Lexicographic> builder_t;
+                size_t node_idx = 0;
                 size_t matching_idx = 0;
+                while (true) {
+                    labels.seek_node(node_idx);
+                    NodeBranches nb = node_branches(node_idx);
+                    size_t label_idx = static_cast<size_t>(word_positions[node_idx]);
+                    size_t branch_idx = nb.first;
+                    while (true) {
+                        uint16_t label = labels[label_idx];
+                        if (label == builder_t::DELIMITER_FLAG) {
+                            size_t rank = rank_of_node(node_idx);
+                            if (m_tails.empty() || !m_tails.has_tail(node_idx)) return rank;     // `val` matched
+                            // the rest of `val` against the tail and its WORD_EOF
+                            const uint8_t* tail;
+                            size_t tail_len;
+                            m_tails.tail(node_idx, tail, tail_len);
+                            for (size_t j = 0; j < tail_len; ++j) {
+                                uint16_t c = val[matching_idx + j];
+                                if (c != tail[j]) return symbol_order(c) < tail[j] ? rank : rank + 1;
+                            }
+                            return val[matching_idx + tail_len] == builder_t::WORD_EOF ? rank : rank + 1;
+                        }
+                        uint16_t c = val[matching_idx];
+                        if (label >> 8 != 1) {
+                            if (c == label) {
+                                ++matching_idx;
+                                ++label_idx;
+                                continue;
+                            }
+                            // the keys below this label all continue with it
+                            return symbol_order(c) < symbol_order(label)
+                                   ? extreme_rank<false>(node_idx, label_idx, branch_idx, labels)
+                                   : extreme_rank<true>(node_idx, label_idx, branch_idx, labels) + 1;
+                        }
+                        size_t n_light = static_cast<uint8_t>(label) + 1;
+                        uint16_t heavy = labels[label_idx + 1];
+                        if (c == heavy) {
+                            ++matching_idx;
+                            label_idx += 2;
+                            branch_idx += n_light;
+                            continue;
+                        }
+                        // the next symbols: heavy, then the light branches
+                        int oc = symbol_order(c);
+                        size_t above = size_t(-1), top = size_t(-1);     // n_light for the heavy symbol
+                        size_t found = n_light;
+                        for (size_t j = 0; j <= n_light; ++j) {
+                            uint16_t symbol = j < n_light ? m_branches[branch_idx + j] : heavy;
+                            if (symbol == c) found = j;
+                            int o = symbol_order(symbol);
+                            if (o > oc && (above == size_t(-1) || o < symbol_order(
+                                    above < n_light ? m_branches[branch_idx + above] : heavy))) {
+                                above = j;
+                            }
+                            if (top == size_t(-1) || o > symbol_order(
+                                    top < n_light ? m_branches[branch_idx + top] : heavy)) {
+                                top = j;
+                            }
+                        }
+                        if (found < n_light) {
+                            node_idx = child_node(nb, branch_idx + found);
+                            ++matching_idx;
+                            break;
+                        }
+                        // past the symbols below `c`
+                        bool after = above == size_t(-1);
+                        size_t next = after ? top : above;
+                        if (next == n_light) {
+                            size_t rank = after ? extreme_rank<true>(node_idx, label_idx + 2, branch_idx + n_light, labels)
+                                                : extreme_rank<false>(node_idx, label_idx + 2, branch_idx + n_light, labels);
+                            return after ? rank + 1 : rank;
+                        }
+                        size_t child = child_node(nb, branch_idx + next);
+                        labels.seek_node(child);
+                        size_t child_first = node_branches(child).first;
+                        size_t child_label = static_cast<size_t>(word_positions[child]);
+                        return after ? extreme_rank<true>(child, child_label, child_first, labels) + 1
+                                     : extreme_rank<false>(child, child_label, child_first, labels);
+                    }
+                }
+            }
+
+            template <typename Tracer, typename LabelReader>
+            bool match_labels(const uint16_t* val, size_t len, size_t stop,
+                              IndexState& state, int& result, Tracer& tracer, LabelReader& labels) const {
+                size_t cur_node_idx = state.node_idx;
+                size_t matching_idx = state.matching_idx;
+                bool resume = true;
                 // matching in the trie.
+                bool use_nav = !m_nav.empty();
                 while (true) {
-                    size_t cur_label_idx = static_cast<size_t>(word_positions[cur_node_idx]);
-                    size_t cur_node_bp_idx = m_bp.select0(cur_node_idx);
+                    PDT_COUNT(TRIE_INDEX_NODES);
+                    labels.seek_node(cur_node_idx);
+                    size_t cur_label_idx;
+                    if (resume && state.label_idx != size_t(-1)) {
+                        cur_label_idx = state.label_idx;
+                    } else {
+                        cur_label_idx = static_cast<size_t>(word_positions[cur_node_idx]);
+                        tracer.touch(word_positions.data() + cur_node_idx);
+                    }
+                    size_t cur_node_bp_idx = size_t(-1);
                     size_t all_branch_num, branch_end;
-                    get_branch_idx_by_node_idx(cur_node_idx, branch_end, all_branch_num);
-                    size_t cur_branch_idx = (branch_end + 1) - all_branch_num;
+                    if (use_nav) {
+                        size_t branch_begin;
+                        m_nav.branch_range(cur_node_idx, branch_begin, branch_end);
+                        tracer.node(cur_node_idx, cur_node_bp_idx, cur_label_idx, matching_idx);
+                        tracer.touch(m_nav.first_branch.word_ptr(cur_node_idx));
+                        all_branch_num = branch_end - branch_begin;
+                        branch_end -= 1;
+                    } else {
+                        cur_node_bp_idx = m_bp.select0(cur_node_idx);
+                        tracer.node(cur_node_idx, cur_node_bp_idx, cur_label_idx, matching_idx);
+                        tracer.bp(cur_node_bp_idx, bp_word(cur_node_bp_idx));
+                        get_branch_idx_by_node_idx(cur_node_idx, branch_end, all_branch_num, tracer);
+                    }
+                    size_t cur_branch_idx = resume && state.branch_idx != size_t(-1)
+                                            ? state.branch_idx : (branch_end + 1) - all_branch_num;
+                    resume = false;
                     // matching in a node.
                     while (true) {
-                        if (m_labels[cur_label_idx] ==
-                            DefaultTreeBuilder<Lexicographic>::DELIMITER_FLAG) {
-                            return (matching_idx == len ? cur_node_idx : -1);
+                        if (matching_idx == stop) {
+                            state.node_idx = cur_node_idx;
+                            state.label_idx = cur_label_idx;
+                            state.branch_idx = cur_branch_idx;
+                            state.matching_idx = matching_idx;
+                            return true;
+                        }
+                        PDT_COUNT(TRIE_INDEX_LABELS);
+                        tracer.label(cur_label_idx, labels.ptr(cur_label_idx));
+                        uint16_t label = labels[cur_label_idx];
+                        if (label == DefaultTreeBuilder<Lexicographic>::DELIMITER_FLAG) {
+                            if (!m_tails.empty() && m_tails.has_tail(cur_node_idx)) {
+                                if (stop != size_t(-1)) {
+                                    result = STOPPED_IN_TAIL;
+                                    return false;
+                                }
+                                PDT_COUNT(TRIE_INDEX_TAILS);
+                                const uint8_t* tail;
+                                size_t tail_len;
+                                m_tails.tail(cur_node_idx, tail, tail_len);
+                                tracer.touch(tail);
+                                bool equal = m_tails.equals(cur_node_idx, val + matching_idx, len - matching_idx,
+                                                            DefaultTreeBuilder<Lexicographic>::WORD_EOF);
+                                result = equal ? int(cur_node_idx) : -1;
+                                return false;
+                            }
+                            result = matching_idx == len ? int(cur_node_idx) : -1;
+                            return false;
                         }
                         if (matching_idx >= len) {
-                            return -1;
+                            result = -1;
+                            return false;
                         }
-                        if (m_labels[cur_label_idx] >> 8 == 1) {
-                            auto branch0 = m_labels[cur_label_idx + 1];
-                            size_t cur_branch_num = static_cast<uint8_t>(m_labels[cur_label_idx]) + 1;
+                        if (label >> 8 == 1) {
+                            auto branch0 = labels[cur_label_idx + 1];
+                            tracer.label(cur_label_idx + 1, labels.ptr(cur_label_idx + 1));
+                            size_t cur_branch_num = static_cast<uint8_t>(label) + 1;
 
                             if (branch0 == val[matching_idx]) {
                                 // update `cur_branch_idx`.
@@ -145,28 +807,38 @@ namespace succinct {
                             } else {
                                 // check branches.
                                 assert(cur_branch_num <= all_branch_num);
-                                bool find_branch = false;
-                                size_t cur_branch_end = cur_branch_idx + cur_branch_num - 1;
-                                while (cur_branch_idx <= cur_branch_end) {
-                                    if (m_branches[cur_branch_idx] == val[matching_idx]) {
-                                        matching_idx++;
-                                        // update `cur_node_idx`.
-                                        cur_node_idx = get_node_idx_by_branch_idx(
-                                                cur_node_bp_idx + cur_branch_idx - (branch_end + 1)
-                                                );
-                                        find_branch = true;
-                                        break;
-                                    }
-                                    cur_branch_idx++;
+                                PDT_COUNT(TRIE_BRANCH_SCANS);
+                                const uint16_t* run = m_branches.data() + cur_branch_idx;
+                                size_t found = find_branch<Lexicographic>(run, cur_branch_num, val[matching_idx]);
+                                bool has_branch = found < cur_branch_num;
+                                // reported as the linear scan up to the match
+                                size_t scanned = has_branch ? found + 1 : cur_branch_num;
+                                PDT_COUNT_N(TRIE_BRANCH_SCAN_STEPS, scanned);
+                                for (size_t i = 0; i < scanned; ++i) tracer.branch(run + i);
+                                tracer.branch_scan(scanned, has_branch);
+                                if (!has_branch) {
+                                    result = -1;
+                                    return false;
                                 }
-                                if (find_branch) break;
-                                return -1;
+                                cur_branch_idx += found;
+                                matching_idx++;
+                                // update `cur_node_idx`.
+                                if (use_nav) {
+                                    tracer.touch(m_nav.child.word_ptr(cur_branch_idx));
+                                    cur_node_idx = m_nav.child[cur_branch_idx];
+                                } else {
+                                    cur_node_idx = get_node_idx_by_branch_idx(
+                                            cur_node_bp_idx + cur_branch_idx - (branch_end + 1), tracer
+                                            );
+                                }
+                                break;
                             }
                         } else {
-                            if (m_labels[cur_label_idx] == val[matching_idx]) {
+                            if (label == val[matching_idx]) {
                                 matching_idx++;
                             } else {
-                                return -1;
+                                result = -1;
+                                return false;
                             }
                         }
                         cur_label_idx++;
@@ -174,50 +846,83 @@ namespace succinct {
                 }
             }
 
+            inline const uint64_t* bp_word(uint64_t pos) const {
+                return m_bp.word_ptr(pos / 64);
+            }
+
             // It seems that we can't avoid copy for returning result.
             // get `idx`-th string in string set.
             std::vector<uint8_t> operator[](size_t idx) const {
                 std::vector<uint8_t> res;
                 if (idx + 1 >= word_positions.size()) return res;
-                uint16_t branch;
+                PDT_COUNT(TRIE_ACCESS);
+                // set by the parent lookup before `branch_no` can be nonzero
+                uint16_t branch = 0;
                 size_t branch_no = 0;
+                std::vector<uint16_t> decoded;
                 do {
-                    if (word_positions[idx + 1] < 2) continue;
-                    size_t cur_label_idx = static_cast<size_t>(word_positions[idx + 1]) - 2;
-                    size_t branch_cnt = 0;
-                    while (true) {
-                        if (m_labels[cur_label_idx] ==
-                            DefaultTreeBuilder<Lexicographic>::DELIMITER_FLAG) {
-                            break;
+                    PDT_COUNT(TRIE_ACCESS_NODES);
+                    // the labels of the node, without the delimiter
+                    size_t first = static_cast<size_t>(word_positions[idx]);
+                    size_t n_labels = static_cast<size_t>(word_positions[idx + 1]) - 1 - first;
+                    // `m_labels` is empty when the labels are compressed
+                    const uint16_t* labels;
+                    if (!m_repair_labels.empty() || (!m_tails.empty() && m_tails.has_tail(idx))) {
+                        decoded.clear();
+                        if (!m_repair_labels.empty()) {
+                            m_repair_labels.decode_node(idx, decoded);
+                        } else {
+                            decoded.insert(decoded.end(), m_labels.data() + first, m_labels.data() + first + n_labels);
                         }
-                        if (cur_label_idx && m_labels[cur_label_idx - 1] >> 8 == 1) {
-                            size_t cur_branch_num = static_cast<uint8_t>(m_labels[cur_label_idx - 1]) + 1;
+                        if (!m_tails.empty() && m_tails.has_tail(idx)) {
+                            const uint8_t* tail;
+                            size_t tail_len;
+                            m_tails.tail(idx, tail, tail_len);
+                            decoded.insert(decoded.end(), tail, tail + tail_len);
+                            decoded.push_back(DefaultTreeBuilder<Lexicographic>::WORD_EOF);
+                        }
+                        labels = decoded.data();
+                        n_labels = decoded.size();
+                    } else {
+                        labels = m_labels.data() + first;
+                    }
+                    // from the last label back to the first one
+                    size_t cur = n_labels;
+                    size_t branch_cnt = 0;
+                    while (cur) {
+                        PDT_COUNT(TRIE_ACCESS_LABELS);
+                        size_t cur_label_idx = cur - 1;
+                        if (cur_label_idx && labels[cur_label_idx - 1] >> 8 == 1) {
+                            size_t cur_branch_num = static_cast<uint8_t>(labels[cur_label_idx - 1]) + 1;
                             if (branch_no) {
                                 if (branch_cnt + cur_branch_num >= branch_no) {
                                     if (branch_cnt < branch_no) {
                                         res.push_back(branch);
                                     } else {
-                                        res.push_back(static_cast<uint8_t>(m_labels[cur_label_idx]));
+                                        res.push_back(static_cast<uint8_t>(labels[cur_label_idx]));
                                     }
                                 }
                             } else {
-                                res.push_back(static_cast<uint8_t>(m_labels[cur_label_idx]));
+                                res.push_back(static_cast<uint8_t>(labels[cur_label_idx]));
                             }
                             branch_cnt += cur_branch_num;
-                            if (cur_label_idx == 1) break;
-                            cur_label_idx -= 2;
+                            cur -= 2;
                             continue;
                         } else {
                             if (!branch_no || branch_cnt >= branch_no) {
-                                res.push_back(static_cast<uint8_t>(m_labels[cur_label_idx]));
+                                res.push_back(static_cast<uint8_t>(labels[cur_label_idx]));
                             }
                         }
-                        if (!cur_label_idx) break;
-                        cur_label_idx--;
+                        cur--;
                     }
                 } while (get_parent_node_branch_by_node_idx(idx, idx, branch, branch_no));
                 std::reverse(res.begin(), res.end());
                 res.pop_back();
+                if (!m_key_encoder.empty()) {
+                    std::vector<uint8_t> key;
+                    m_key_encoder.decode(res.data(), res.size(), key);
+                    return key;
+                }
                 return res;
             }
         };
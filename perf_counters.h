@@ -0,0 +1,178 @@
+//
+// Opt-in hot-path counters of the succinct operations.
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_PERF_COUNTERS_H
+#define PATH_DECOMPOSITION_TRIE_PERF_COUNTERS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// The counters are compiled in only when PDT_ENABLE_COUNTERS is defined (for every
+// translation unit, including balanced_parentheses_vector.cpp), otherwise
+// PDT_COUNT / PDT_COUNT_N expand to nothing and cost nothing.
+//
+// Every thread increments its own counters, `snapshot()` sums the counters
+// of all live threads plus the ones of the threads that already exited.
+//
+//     succinct::counters::reset();
+//     ... lookups ...
+//     auto s = succinct::counters::snapshot();
+//     s[succinct::counters::SELECT0]
+//
+namespace succinct {
+    namespace counters {
+        enum counter_id {
+            // RsBitVector / BitVector
+            RANK,
+            SELECT,
+            SELECT_STEPS,           // binary search steps over blocks (lines: InterleavedRsBitVector, words: Darray)
+            SELECT0,
+            SELECT0_STEPS,
+            PREDECESSOR0,
+            PREDECESSOR0_WORDS,     // words scanned backwards
+            SUCCESSOR0,
+            SUCCESSOR0_WORDS,
+            // BpVector
+            FIND_CLOSE,
+            FIND_OPEN,
+            BP_IN_BLOCK,            // find_close/find_open not resolved in the first word
+            BP_BLOCK_WORDS,         // words scanned by find_{close,open}_in_block
+            BP_MIN_TREE,            // find_close/find_open not resolved in the local block
+            BP_SUPERBLOCK_STEPS,    // blocks scanned by search_block_in_superblock
+            BP_TREE_STEPS,          // nodes visited in the superblock min-tree
+            EXCESS_RMQ,
+            // DefaultPathDecomposedTrie
+            TRIE_INDEX,
+            TRIE_INDEX_NODES,       // nodes visited by index()
+            TRIE_INDEX_LABELS,      // labels compared by index()
+            TRIE_INDEX_TAILS,       // tails compared by index() (separate_tails())
+            TRIE_BRANCH_SCANS,      // searches of a branch run (branch_search.h)
+            TRIE_BRANCH_SCAN_STEPS, // branches up to the match, as a linear scan would compare
+            TRIE_ACCESS,
+            TRIE_ACCESS_NODES,      // nodes visited by operator[]
+            TRIE_ACCESS_LABELS,     // labels read by operator[]
+            N_COUNTERS
+        };
+
+        inline const char* counter_name(counter_id id) {
+            static const char* const names[N_COUNTERS] = {
+                    "rank", "select", "select_steps", "select0", "select0_steps",
+                    "predecessor0", "predecessor0_words", "successor0", "successor0_words",
+                    "find_close", "find_open", "bp_in_block", "bp_block_words", "bp_min_tree",
+                    "bp_superblock_steps", "bp_tree_steps", "excess_rmq",
+                    "trie_index", "trie_index_nodes", "trie_index_labels", "trie_index_tails",
+                    "trie_branch_scans", "trie_branch_scan_steps",
+                    "trie_access", "trie_access_nodes", "trie_access_labels"};
+            return names[id];
+        }
+
+        struct Snapshot {
+            uint64_t values[N_COUNTERS] = {};
+
+            uint64_t operator[](counter_id id) const {
+                return values[id];
+            }
+        };
+
+        namespace detail {
+            struct LocalCounters;
+
+            struct Registry {
+                std::mutex mutex;
+                std::vector<LocalCounters*> threads;
+                Snapshot retired;       // counters of the exited threads
+                Snapshot baseline;      // subtracted by snapshot(), set by reset()
+            };
+
+            inline Registry& registry() {
+                static Registry r;
+                return r;
+            }
+
+            // Only the owner thread writes `values`, a relaxed load + store
+            // is enough (no locked instruction) and lets other threads read them.
+            struct LocalCounters {
+                std::atomic<uint64_t> values[N_COUNTERS];
+
+                LocalCounters() {
+                    for (auto& v : values) v.store(0, std::memory_order_relaxed);
+                    Registry& r = registry();
+                    std::lock_guard<std::mutex> lock(r.mutex);
+                    r.threads.push_back(this);
+                }
+
+                ~LocalCounters() {
+                    Registry& r = registry();
+                    std::lock_guard<std::mutex> lock(r.mutex);
+                    for (size_t i = 0; i < N_COUNTERS; ++i) {
+                        r.retired.values[i] += values[i].load(std::memory_order_relaxed);
+                    }
+                    for (size_t i = 0; i < r.threads.size(); ++i) {
+                        if (r.threads[i] == this) {
+                            r.threads[i] = r.threads.back();
+                            r.threads.pop_back();
+                            break;
+                        }
+                    }
+                }
+
+                inline void add(counter_id id, uint64_t n) {
+                    values[id].store(values[id].load(std::memory_order_relaxed) + n,
+                                     std::memory_order_relaxed);
+                }
+            };
+
+            inline LocalCounters& local() {
+                thread_local LocalCounters counters;
+                return counters;
+            }
+
+            inline Snapshot total(Registry& r) {
+                Snapshot s = r.retired;
+                for (auto* t : r.threads) {
+                    for (size_t i = 0; i < N_COUNTERS; ++i) {
+                        s.values[i] += t->values[i].load(std::memory_order_relaxed);
+                    }
+                }
+                return s;
+            }
+        }
+
+        inline void add(counter_id id, uint64_t n = 1) {
+            detail::local().add(id, n);
+        }
+
+        // sum of all threads since the last `reset()`
+        inline Snapshot snapshot() {
+            detail::Registry& r = detail::registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            Snapshot s = detail::total(r);
+            for (size_t i = 0; i < N_COUNTERS; ++i) {
+                s.values[i] -= r.baseline.values[i];
+            }
+            return s;
+        }
+
+        // The thread-local counters are never written by another thread,
+        // resetting only moves the baseline of `snapshot()`.
+        inline void reset() {
+            detail::Registry& r = detail::registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.baseline = detail::total(r);
+        }
+    }
+}
+
+#ifdef PDT_ENABLE_COUNTERS
+#define PDT_COUNT(id) ::succinct::counters::add(::succinct::counters::id)
+#define PDT_COUNT_N(id, n) ::succinct::counters::add(::succinct::counters::id, (n))
+#else
+#define PDT_COUNT(id) ((void)0)
+#define PDT_COUNT_N(id, n) ((void)0)
+#endif
+
+#endif //PATH_DECOMPOSITION_TRIE_PERF_COUNTERS_H
@@ -0,0 +1,113 @@
+//
+// Bit-packed permutation with a sampled inverse, see
+// DefaultPathDecomposedTrie::build_rank_index().
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_PERMUTATION_H
+#define PATH_DECOMPOSITION_TRIE_PERMUTATION_H
+
+#include <cassert>
+#include <vector>
+
+#include "compact_vector.h"
+#include "rank_select_bit_vector.h"
+
+namespace succinct {
+    //
+    // `operator[]` reads the bit-packed values, `inverse()` walks the cycle
+    // of its argument with the shortcuts of Munro, Raman, Raman and Rao:
+    // every `step`-th element of a cycle longer than `step` is marked and
+    // keeps the element `step` positions behind it (the first mark keeps the
+    // last one), so the predecessor is at most 2 * `step` links away. The
+    // shortcuts cost about (log n + 1) / `step` + 1 bits per element.
+    //
+    class Permutation {
+    public:
+        static const size_t DEFAULT_STEP = 16;
+
+        Permutation() {}
+
+        // `values`: a permutation of [0, values.size())
+        explicit Permutation(const std::vector<uint64_t>& values, size_t step = DEFAULT_STEP) {
+            assert(step >= 1);
+            size_t n = values.size();
+            std::vector<bool> marks(n, false), visited(n, false);
+            std::vector<uint64_t> back_of(n, 0);
+            std::vector<uint64_t> cycle;
+            for (size_t first = 0; first < n; ++first) {
+                if (visited[first]) continue;
+                cycle.clear();
+                for (uint64_t i = first; !visited[i]; i = values[i]) {
+                    assert(i < n);
+                    visited[i] = true;
+                    cycle.push_back(i);
+                }
+                if (cycle.size() <= step) continue;
+                size_t last_mark = (cycle.size() - 1) / step * step;
+                for (size_t j = 0; j < cycle.size(); j += step) {
+                    marks[cycle[j]] = true;
+                    back_of[cycle[j]] = cycle[j ? j - step : last_mark];
+                }
+            }
+            std::vector<uint64_t> back;
+            for (size_t i = 0; i < n; ++i) {
+                if (marks[i]) back.push_back(back_of[i]);
+            }
+            CompactVector values_vec(values), back_vec(back, CompactVector::bits_for(n ? n - 1 : 0));
+            m_values_.swap(values_vec);
+            m_back_.swap(back_vec);
+            RsBitVector marks_vec(marks);
+            m_marks_.swap(marks_vec);
+        }
+
+        void swap(Permutation& other) {
+            m_values_.swap(other.m_values_);
+            m_marks_.swap(other.m_marks_);
+            m_back_.swap(other.m_back_);
+        }
+
+        inline size_t size() const {
+            return m_values_.size();
+        }
+
+        inline bool empty() const {
+            return m_values_.empty();
+        }
+
+        inline uint64_t operator[](size_t i) const {
+            return m_values_[i];
+        }
+
+        // the `i` with `(*this)[i] == v`
+        uint64_t inverse(uint64_t v) const {
+            uint64_t i = v;
+            bool jumped = false;
+            while (true) {
+                uint64_t next = m_values_[i];
+                if (next == v) return i;
+                // a back pointer lands behind `v` at most once
+                if (!jumped && m_marks_[i]) {
+                    i = m_back_[m_marks_.rank(i)];
+                    jumped = true;
+                } else {
+                    i = next;
+                }
+            }
+        }
+
+        SpaceReport space_report() const {
+            SpaceReport report;
+            report.add("values", m_values_.bytes(), m_values_.is_owned());
+            report.add("marks", m_marks_.space_report());
+            report.add("back", m_back_.bytes(), m_back_.is_owned());
+            return report;
+        }
+
+    private:
+        CompactVector m_values_;
+        RsBitVector m_marks_;
+        CompactVector m_back_;          // for each mark, in order
+    };
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_PERMUTATION_H
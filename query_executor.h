@@ -0,0 +1,212 @@
+//
+// Thread pool running bulk lookups over a span of queries, with work
+// stealing between the threads.
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_QUERY_EXECUTOR_H
+#define PATH_DECOMPOSITION_TRIE_QUERY_EXECUTOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace succinct {
+    namespace trie {
+        //
+        // `parallel_for(n, chunk_size, kernel)` cuts [0, n) in chunks of
+        // `chunk_size` items and calls `kernel(begin, end)` once per chunk from
+        // the calling thread and `num_threads() - 1` pooled workers.
+        //
+        // Every thread starts with a contiguous run of chunks packed in one
+        // atomic word (first << 32 | end): the owner takes chunks from the
+        // front and, once its run is empty, steals one at a time from the back
+        // of the other runs, so a slow run (long keys, cold pages) is shared
+        // out at the end. Taking a chunk is one CAS, the items themselves are
+        // not synchronized: the kernel writes the results of its own chunk
+        // into a preallocated output, threads only share the cache lines at
+        // the chunk boundaries.
+        //
+        // The kernel must not throw. One `parallel_for` at a time.
+        //
+        class QueryExecutor {
+        public:
+            // `n_threads` including the caller, 0 for the hardware threads
+            explicit QueryExecutor(size_t n_threads = 0)
+                    : m_n_threads_(n_threads ? n_threads : std::max<size_t>(1, std::thread::hardware_concurrency()))
+                    , m_runs_(allocate_runs(m_n_threads_)) {
+                for (size_t w = 1; w < m_n_threads_; ++w) {
+                    m_workers_.emplace_back([this, w] { worker_loop(w); });
+                }
+            }
+
+            ~QueryExecutor() {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex_);
+                    m_stop_ = true;
+                }
+                m_start_cv_.notify_all();
+                for (auto& t : m_workers_) t.join();
+                free(m_runs_);
+            }
+
+            QueryExecutor(const QueryExecutor&) = delete;
+            QueryExecutor& operator=(const QueryExecutor&) = delete;
+
+            size_t num_threads() const {
+                return m_n_threads_;
+            }
+
+            template <typename Kernel>
+            void parallel_for(size_t n, size_t chunk_size, const Kernel& kernel) {
+                if (!n) return;
+                assert(chunk_size);
+                size_t n_chunks = (n + chunk_size - 1) / chunk_size;
+                assert(n_chunks < (uint64_t(1) << 32));
+                std::function<void(size_t)> run_chunk = [&](size_t c) {
+                    kernel(c * chunk_size, std::min(n, (c + 1) * chunk_size));
+                };
+                for (size_t w = 0; w < m_n_threads_; ++w) {
+                    m_runs_[w].chunks.store(pack(n_chunks * w / m_n_threads_, n_chunks * (w + 1) / m_n_threads_),
+                                            std::memory_order_relaxed);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex_);
+                    m_job_ = &run_chunk;
+                    m_active_ = m_n_threads_ - 1;
+                    ++m_generation_;
+                }
+                m_start_cv_.notify_all();
+                work(0);
+                std::unique_lock<std::mutex> lock(m_mutex_);
+                m_done_cv_.wait(lock, [this] { return !m_active_; });
+                m_job_ = nullptr;
+            }
+
+        private:
+            struct alignas(64) ChunkRun {
+                std::atomic<uint64_t> chunks{0};
+            };
+
+            // `new[]` of C++14 does not honour the alignment of ChunkRun: the
+            // runs would share cache lines
+            static ChunkRun* allocate_runs(size_t n) {
+                void* ptr = nullptr;
+                if (posix_memalign(&ptr, sizeof(ChunkRun), n * sizeof(ChunkRun))) {
+                    throw std::bad_alloc();
+                }
+                ChunkRun* runs = static_cast<ChunkRun*>(ptr);
+                for (size_t i = 0; i < n; ++i) {
+                    new (runs + i) ChunkRun();
+                }
+                return runs;
+            }
+
+            static uint64_t pack(uint64_t first, uint64_t end) {
+                return first << 32 | end;
+            }
+
+            // the first chunk of the run of `w`, for its owner
+            bool pop_front(size_t w, size_t& chunk) {
+                uint64_t cur = m_runs_[w].chunks.load(std::memory_order_relaxed);
+                while (true) {
+                    uint64_t first = cur >> 32, end = uint32_t(cur);
+                    if (first >= end) return false;
+                    if (m_runs_[w].chunks.compare_exchange_weak(cur, pack(first + 1, end),
+                                                                std::memory_order_relaxed)) {
+                        chunk = first;
+                        return true;
+                    }
+                }
+            }
+
+            // the last chunk of the run of `w`, for the other threads
+            bool steal_back(size_t w, size_t& chunk) {
+                uint64_t cur = m_runs_[w].chunks.load(std::memory_order_relaxed);
+                while (true) {
+                    uint64_t first = cur >> 32, end = uint32_t(cur);
+                    if (first >= end) return false;
+                    if (m_runs_[w].chunks.compare_exchange_weak(cur, pack(first, end - 1),
+                                                                std::memory_order_relaxed)) {
+                        chunk = end - 1;
+                        return true;
+                    }
+                }
+            }
+
+            // run chunks until every run is empty
+            void work(size_t w) {
+                const std::function<void(size_t)>& job = *m_job_;
+                size_t chunk;
+                while (true) {
+                    if (pop_front(w, chunk)) {
+                        job(chunk);
+                        continue;
+                    }
+                    bool stolen = false;
+                    for (size_t i = 1; i < m_n_threads_ && !stolen; ++i) {
+                        stolen = steal_back((w + i) % m_n_threads_, chunk);
+                    }
+                    if (!stolen) return;
+                    job(chunk);
+                }
+            }
+
+            void worker_loop(size_t w) {
+                uint64_t seen = 0;
+                std::unique_lock<std::mutex> lock(m_mutex_);
+                while (true) {
+                    m_start_cv_.wait(lock, [&] { return m_stop_ || m_generation_ != seen; });
+                    if (m_stop_) return;
+                    seen = m_generation_;
+                    lock.unlock();
+                    work(w);
+                    lock.lock();
+                    if (!--m_active_) m_done_cv_.notify_one();
+                }
+            }
+
+            size_t m_n_threads_;
+            ChunkRun* m_runs_;                  // posix_memalign, see allocate_runs()
+            std::vector<std::thread> m_workers_;
+
+            std::mutex m_mutex_;
+            std::condition_variable m_start_cv_;
+            std::condition_variable m_done_cv_;
+            const std::function<void(size_t)>* m_job_ = nullptr;
+            uint64_t m_generation_ = 0;
+            size_t m_active_ = 0;
+            bool m_stop_ = false;
+        };
+
+        // out[i] = trie.index(keys[i]) for i < n, each chunk through
+        // `trie.index_sorted_batch()`: sorted keys share the hops of their
+        // common prefixes within a chunk
+        template <typename TrieType>
+        void index_all(QueryExecutor& executor, const TrieType& trie,
+                       const std::string* keys, size_t n, int* out, size_t chunk_size = 1024) {
+            executor.parallel_for(n, chunk_size, [&](size_t begin, size_t end) {
+                trie.index_sorted_batch(keys + begin, end - begin, out + begin);
+            });
+        }
+
+        // out[i] = trie[ids[i]] for i < n
+        template <typename TrieType>
+        void access_all(QueryExecutor& executor, const TrieType& trie,
+                        const size_t* ids, size_t n, std::vector<uint8_t>* out, size_t chunk_size = 1024) {
+            executor.parallel_for(n, chunk_size, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) out[i] = trie[ids[i]];
+            });
+        }
+    }
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_QUERY_EXECUTOR_H
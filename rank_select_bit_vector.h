@@ -36,27 +36,41 @@ namespace succinct {
     //          |
     // at last, a dummy tail block is used to save the number of one-bits in `next_rank`
     //
-    class RsBitVector : public BitVector {
+    // `BlockSize` (in 64bit words) and `SelectOnesPerHint` (ones, or zeros, between
+    // two select hints) trade space for speed: the rank directory costs 128 bits
+    // per block and the hints 64 bits per `SelectOnesPerHint` ones. `sub_ranks`
+    // keeps 9-bit lanes for the words 1..7 of a block, so a block has 8 words at most;
+    // with fewer words the lanes of the missing words are 0 and masked out.
+    //
+    template <uint64_t BlockSize = 8, uint64_t SelectOnesPerHint = 64 * BlockSize * 2>
+    class BasicRsBitVector : public BitVector {
+        static_assert(BlockSize >= 1 && BlockSize <= 8, "sub ranks of a block are packed in 7 9-bit lanes");
+        static_assert(SelectOnesPerHint > BlockSize * 64, "a select hint must span more than one block");
+
     public:
-        RsBitVector()
+        static const uint64_t block_size = BlockSize; // in 64bit words
+        static const uint64_t select_ones_per_hint = SelectOnesPerHint;
+        static const uint64_t select_zeros_per_hint = select_ones_per_hint;
+
+        BasicRsBitVector()
             : BitVector()
         {}
 
-        RsBitVector(const std::vector<bool>& bools,
+        BasicRsBitVector(const std::vector<bool>& bools,
                     bool with_select_hints = false,
                     bool with_select0_hints = false)
                     : BitVector(bools) {
             build_indices(with_select_hints, with_select0_hints);
         }
 
-        RsBitVector(BitVectorBuilder* builder,
+        BasicRsBitVector(BitVectorBuilder* builder,
                     bool with_select_hints = false,
                     bool with_select0_hints = false)
                     : BitVector(builder) {
             build_indices(with_select_hints, with_select0_hints);
         }
 
-        RsBitVector(const uint64_t* raw_data,
+        BasicRsBitVector(const uint64_t* raw_data,
                     uint64_t word_size,
                     size_t bit_size,
                     bool with_select_hints = false,
@@ -65,13 +79,21 @@ namespace succinct {
             build_indices(with_select_hints, with_select0_hints);
         }
 
-        void swap(RsBitVector& other) {
+        void swap(BasicRsBitVector& other) {
             BitVector::swap(other);
             m_block_rank_pairs_.swap(other.m_block_rank_pairs_);
             m_select_hints_.swap(other.m_select_hints_);
             m_select0_hints_.swap(other.m_select0_hints_);
         }
 
+        SpaceReport space_report() const {
+            SpaceReport report = BitVector::space_report();
+            report.add("block_rank_pairs", m_block_rank_pairs_);
+            report.add("select_hints", m_select_hints_);
+            report.add("select0_hints", m_select0_hints_);
+            return report;
+        }
+
         inline uint64_t num_ones() const {
             return *(m_block_rank_pairs_.end() - 2);
         }
@@ -83,6 +105,7 @@ namespace succinct {
         // get the number of 1-bits in range [0, `pos`)
         inline uint64_t rank(uint64_t pos) const {
             assert(pos <= size());
+            PDT_COUNT(RANK);
             if (pos == size()) {
                 return num_ones();
             }
@@ -105,6 +128,7 @@ namespace succinct {
         // `n` starts from 0
         inline uint64_t select(uint64_t n) const {
             assert(n < num_ones());
+            PDT_COUNT(SELECT);
             // The possible block index range of `n`-th 1-bit
             // is [block_begin, block end)
             uint64_t block_begin = 0;
@@ -121,6 +145,7 @@ namespace succinct {
             // binary search in block index range [block_begin, block_end)
             while (block_end - block_begin > 1) {
                 uint64_t mid = block_begin + (block_end - block_begin) / 2;
+                PDT_COUNT(SELECT_STEPS);
                 uint64_t x = block_rank(mid);
                 if (x <= n) {
                     block_begin = mid;
@@ -148,6 +173,7 @@ namespace succinct {
         // `n` starts from 0
         inline uint64_t select0(uint64_t n) const {
             assert(n < num_zeros());
+            PDT_COUNT(SELECT0);
             uint64_t block_begin = 0;
             uint64_t block_end = num_blocks();
             if (m_select0_hints_.size()) {
@@ -161,6 +187,7 @@ namespace succinct {
             uint64_t block = 0;
             while (block_end - block_begin > 1) {
                 uint64_t mid = block_begin + (block_end - block_begin) / 2;
+                PDT_COUNT(SELECT0_STEPS);
                 uint64_t x = block_rank0(mid);
                 if (x <= n) {
                     block_begin = mid;
@@ -220,9 +247,9 @@ namespace succinct {
         // `block`: block index
         // `k`: 1-bit's rank in `block`-indexed block
         inline uint64_t get_sub_block_offset(uint64_t w_ranks, uint64_t k) const {
-            uint64_t w_ks = k * SUB_RANK_UNIT;
+            uint64_t w_ks = k * BLOCK_LANES_UNIT;
 
-            const uint64_t indicator = 0x100ULL * SUB_RANK_UNIT;
+            const uint64_t indicator = 0x100ULL * BLOCK_LANES_UNIT;
             // let r = (w_ks | indicator) - (w_ranks & ~indicator)
             // let k = w_ks and x = w_ranks
             // use `w_flags` to represent if w_ks >= w_ranks in each 9-bits
@@ -262,7 +289,7 @@ namespace succinct {
                 next_rank += word_pop;
                 cur_sub_rank += word_pop;
                 if (shift == block_size - 1) {
-                    block_rank_pairs.push_back(sub_ranks);
+                    block_rank_pairs.push_back(sub_ranks << LANE_SHIFT);
                     block_rank_pairs.push_back(next_rank);
                     sub_ranks = 0;
                     cur_sub_rank = 0;
@@ -274,7 +301,7 @@ namespace succinct {
                 sub_ranks <<= 9;
                 sub_ranks |= cur_sub_rank;
             }
-            block_rank_pairs.push_back(sub_ranks);
+            block_rank_pairs.push_back(sub_ranks << LANE_SHIFT);
             // a dummy tail block
             if (m_bits_.size() % block_size) {
                 block_rank_pairs.push_back(next_rank);
@@ -312,21 +339,36 @@ namespace succinct {
             }
         }
 
-        static const uint64_t block_size = 8; // in 64bit words
-        static const uint64_t select_ones_per_hint = 64 * block_size * 2; // must be > block_size * 64
-        static const uint64_t select_zeros_per_hint = select_ones_per_hint;
+        // the lane of word w (1 <= w < block_size) is at bit (7 - w) * 9,
+        // whatever the block size, the built `sub_ranks` are shifted there.
+        static const uint64_t LANE_SHIFT = (8 - block_size) * 9;
 
+        // 1 in every lane
         static const uint64_t SUB_RANK_UNIT =
                 1ULL << 0 | 1ULL << 9 | 1ULL << 18 | 1ULL << 27 | 1ULL << 36 | 1ULL << 45 | 1ULL << 54;
 
+        // 1 in the lanes of the words of a block
+        static const uint64_t BLOCK_LANES_UNIT = (SUB_RANK_UNIT >> LANE_SHIFT) << LANE_SHIFT;
+
+        // w in the lane of word w
         static const uint64_t INV_CNT_UNIT =
-                1ULL << 54 | 2ULL << 45 | 3ULL << 36 | 4ULL << 27 | 5ULL << 18 | 6ULL << 9 | 7ULL;
+                ((1ULL << 54 | 2ULL << 45 | 3ULL << 36 | 4ULL << 27 | 5ULL << 18 | 6ULL << 9 | 7ULL)
+                 >> LANE_SHIFT) << LANE_SHIFT;
 
         typedef mappable_vector<uint64_t> uint64_vec;
         uint64_vec m_block_rank_pairs_;               // `next_rank` & `sub_ranks` pairs
         uint64_vec m_select_hints_;                   // block index
         uint64_vec m_select0_hints_;
     };
+
+    template <uint64_t BlockSize, uint64_t SelectOnesPerHint>
+    const uint64_t BasicRsBitVector<BlockSize, SelectOnesPerHint>::block_size;
+    template <uint64_t BlockSize, uint64_t SelectOnesPerHint>
+    const uint64_t BasicRsBitVector<BlockSize, SelectOnesPerHint>::select_ones_per_hint;
+    template <uint64_t BlockSize, uint64_t SelectOnesPerHint>
+    const uint64_t BasicRsBitVector<BlockSize, SelectOnesPerHint>::select_zeros_per_hint;
+
+    typedef BasicRsBitVector<> RsBitVector;
 }
 
 #endif //PATH_DECOMPOSITION_TRIE_RANK_SELECT_BIT_VECTOR_H
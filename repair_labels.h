@@ -0,0 +1,224 @@
+//
+// Grammar-compressed labels of DefaultPathDecomposedTrie (approximate
+// Re-Pair), see `compress_labels()`.
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_REPAIR_LABELS_H
+#define PATH_DECOMPOSITION_TRIE_REPAIR_LABELS_H
+
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "compact_vector.h"
+
+namespace succinct {
+    namespace trie {
+        //
+        // The label run of every node (without its delimiter) is rewritten
+        // with a grammar shared by all the nodes: a symbol below
+        // `N_TERMINALS` is a label, symbol `N_TERMINALS + r` expands to the
+        // two symbols of rule `r`. Rules never cross nodes, so a node is
+        // decoded from its own offset in the sequence.
+        //
+        // Re-Pair replaces the most frequent pair one at a time; here every
+        // round replaces, left to right, all the pairs seen at least
+        // `MIN_PAIR_COUNT` times (most frequent first, within the rule
+        // budget), which needs a few rounds of hashing instead of the
+        // priority queue and pair index of the exact algorithm.
+        //
+        // The sequence, the node offsets and the rules are bit packed.
+        //
+        class RePairLabels {
+        public:
+            static const uint64_t N_TERMINALS = 1025;     // bytes, specials, delimiter, WORD_EOF
+            static const uint64_t MIN_PAIR_COUNT = 4;
+            static const size_t MAX_ROUNDS = 32;
+
+            RePairLabels() : m_size_(0), m_delimiter_(0) {}
+
+            // `labels`: `n` labels, every node's run closed by `delimiter`
+            RePairLabels(const uint16_t* labels, size_t n, uint16_t delimiter, size_t max_rules = 1 << 16)
+                    : m_size_(n), m_delimiter_(delimiter) {
+                static const uint64_t SEPARATOR = uint64_t(-1);
+                // the runs back to back, a separator after each
+                std::vector<uint64_t> seq;
+                seq.reserve(n);
+                for (size_t i = 0; i < n; ++i) {
+                    assert(labels[i] < N_TERMINALS);
+                    seq.push_back(labels[i] == delimiter ? SEPARATOR : labels[i]);
+                }
+
+                std::vector<uint64_t> rules;
+                for (size_t round = 0; round < MAX_ROUNDS && rules.size() / 2 < max_rules; ++round) {
+                    std::unordered_map<uint64_t, uint64_t> counts;
+                    for (size_t i = 0; i + 1 < seq.size(); ++i) {
+                        if (seq[i] != SEPARATOR && seq[i + 1] != SEPARATOR) {
+                            ++counts[pair_key(seq[i], seq[i + 1])];
+                        }
+                    }
+                    std::vector<std::pair<uint64_t, uint64_t>> frequent;     // (count, pair)
+                    for (auto& c : counts) {
+                        if (c.second >= MIN_PAIR_COUNT) frequent.emplace_back(c.second, c.first);
+                    }
+                    if (frequent.empty()) break;
+                    std::sort(frequent.begin(), frequent.end(), std::greater<std::pair<uint64_t, uint64_t>>());
+                    frequent.resize(std::min(frequent.size(), max_rules - rules.size() / 2));
+
+                    std::unordered_map<uint64_t, uint64_t> symbol_of;
+                    for (auto& f : frequent) {
+                        symbol_of[f.second] = N_TERMINALS + rules.size() / 2;
+                        rules.push_back(f.second >> 32);
+                        rules.push_back(uint32_t(f.second));
+                    }
+                    size_t out = 0;
+                    for (size_t i = 0; i < seq.size(); ++i) {
+                        if (i + 1 < seq.size() && seq[i] != SEPARATOR && seq[i + 1] != SEPARATOR) {
+                            auto it = symbol_of.find(pair_key(seq[i], seq[i + 1]));
+                            if (it != symbol_of.end()) {
+                                seq[out++] = it->second;
+                                ++i;
+                                continue;
+                            }
+                        }
+                        seq[out++] = seq[i];
+                    }
+                    seq.resize(out);
+                }
+
+                std::vector<uint64_t> symbols, node_offsets;
+                node_offsets.push_back(0);
+                for (auto s : seq) {
+                    if (s == SEPARATOR) {
+                        node_offsets.push_back(symbols.size());
+                    } else {
+                        symbols.push_back(s);
+                    }
+                }
+                uint64_t width = CompactVector::bits_for(N_TERMINALS + rules.size() / 2);
+                CompactVector symbols_vec(symbols, width), offsets_vec(node_offsets), rules_vec(rules, width);
+                m_symbols_.swap(symbols_vec);
+                m_node_offsets_.swap(offsets_vec);
+                m_rules_.swap(rules_vec);
+            }
+
+            void swap(RePairLabels& other) {
+                std::swap(m_size_, other.m_size_);
+                std::swap(m_delimiter_, other.m_delimiter_);
+                m_symbols_.swap(other.m_symbols_);
+                m_node_offsets_.swap(other.m_node_offsets_);
+                m_rules_.swap(other.m_rules_);
+            }
+
+            // number of labels, delimiters included
+            inline size_t size() const {
+                return m_size_;
+            }
+
+            inline bool empty() const {
+                return !m_size_;
+            }
+
+            size_t num_rules() const {
+                return m_rules_.size() / 2;
+            }
+
+            size_t num_symbols() const {
+                return m_symbols_.size();
+            }
+
+            // append the labels of `node` to `out`, without the delimiter
+            void decode_node(size_t node, std::vector<uint16_t>& out) const {
+                std::vector<uint64_t> stack;
+                for (size_t i = m_node_offsets_[node]; i < m_node_offsets_[node + 1]; ++i) {
+                    expand(m_symbols_[i], out, stack);
+                }
+            }
+
+            SpaceReport space_report() const {
+                SpaceReport report;
+                report.add("symbols", m_symbols_.bytes(), m_symbols_.is_owned());
+                report.add("node_offsets", m_node_offsets_.bytes(), m_node_offsets_.is_owned());
+                report.add("rules", m_rules_.bytes(), m_rules_.is_owned());
+                return report;
+            }
+
+            //
+            // Forward reads of the labels of one node at a time, as `index()`
+            // does: the symbols are expanded into a buffer as the reads get
+            // past it. `word_positions` are the first labels of the nodes.
+            //
+            class Reader {
+            public:
+                Reader(const RePairLabels& labels, const uint64_t* word_positions)
+                        : m_labels_(labels), m_word_positions_(word_positions)
+                        , m_first_(0), m_next_(0), m_end_(0) {}
+
+                inline void seek_node(size_t node) {
+                    m_first_ = m_word_positions_[node];
+                    m_next_ = m_labels_.m_node_offsets_[node];
+                    m_end_ = m_labels_.m_node_offsets_[node + 1];
+                    m_buffer_.clear();
+                }
+
+                // label `i` of the trie, `i` in the current node
+                inline uint16_t operator[](size_t i) {
+                    return *ptr(i);
+                }
+
+                inline const uint16_t* ptr(size_t i) {
+                    assert(i >= m_first_);
+                    while (i - m_first_ >= m_buffer_.size()) {
+                        if (m_next_ == m_end_) {
+                            m_buffer_.push_back(m_labels_.m_delimiter_);
+                            break;
+                        }
+                        m_labels_.expand(m_labels_.m_symbols_[m_next_++], m_buffer_, m_stack_);
+                    }
+                    assert(i - m_first_ < m_buffer_.size());
+                    return m_buffer_.data() + (i - m_first_);
+                }
+
+            private:
+                const RePairLabels& m_labels_;
+                const uint64_t* m_word_positions_;
+                size_t m_first_;
+                size_t m_next_;
+                size_t m_end_;
+                std::vector<uint16_t> m_buffer_;
+                std::vector<uint64_t> m_stack_;
+            };
+
+        private:
+            static inline uint64_t pair_key(uint64_t a, uint64_t b) {
+                return a << 32 | b;
+            }
+
+            // append the labels of `symbol` to `out`
+            inline void expand(uint64_t symbol, std::vector<uint16_t>& out, std::vector<uint64_t>& stack) const {
+                stack.push_back(symbol);
+                while (!stack.empty()) {
+                    uint64_t s = stack.back();
+                    stack.pop_back();
+                    if (s < N_TERMINALS) {
+                        out.push_back(uint16_t(s));
+                    } else {
+                        uint64_t r = s - N_TERMINALS;
+                        stack.push_back(m_rules_[2 * r + 1]);
+                        stack.push_back(m_rules_[2 * r]);
+                    }
+                }
+            }
+
+            size_t m_size_;
+            uint16_t m_delimiter_;
+            CompactVector m_symbols_;
+            CompactVector m_node_offsets_;
+            CompactVector m_rules_;
+        };
+    }
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_REPAIR_LABELS_H
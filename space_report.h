@@ -0,0 +1,82 @@
+//
+// Memory accounting of the succinct structures.
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_SPACE_REPORT_H
+#define PATH_DECOMPOSITION_TRIE_SPACE_REPORT_H
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "mappable_vector.h"
+
+namespace succinct {
+    // One array of a structure. `owned` arrays are allocated by the structure,
+    // the others are mapped on a buffer owned by the caller (the decoding
+    // constructors), e.g. a block in the block cache.
+    struct SpaceComponent {
+        std::string name;
+        uint64_t bytes;
+        bool owned;
+    };
+
+    // Exact bytes of every array of a structure, `space_report()` of BitVector,
+    // RsBitVector, BpVector and DefaultPathDecomposedTrie.
+    struct SpaceReport {
+        std::vector<SpaceComponent> components;
+
+        void add(const std::string& name, uint64_t bytes, bool owned) {
+            components.push_back(SpaceComponent{name, bytes, owned});
+        }
+
+        template <typename T>
+        void add(const std::string& name, const mappable_vector<T>& vec) {
+            add(name, vec.bytes(), vec.is_owned());
+        }
+
+        // add the components of `other` as "<prefix>.<name>"
+        void add(const std::string& prefix, const SpaceReport& other) {
+            for (auto& c : other.components) {
+                add(prefix + "." + c.name, c.bytes, c.owned);
+            }
+        }
+
+        uint64_t total_bytes() const {
+            uint64_t n = 0;
+            for (auto& c : components) n += c.bytes;
+            return n;
+        }
+
+        uint64_t owned_bytes() const {
+            uint64_t n = 0;
+            for (auto& c : components) n += c.owned ? c.bytes : 0;
+            return n;
+        }
+
+        uint64_t mapped_bytes() const {
+            return total_bytes() - owned_bytes();
+        }
+
+        // bytes of the component `name`, 0 if there is none
+        uint64_t bytes(const std::string& name) const {
+            for (auto& c : components) {
+                if (c.name == name) return c.bytes;
+            }
+            return 0;
+        }
+
+        std::string to_string() const {
+            std::ostringstream out;
+            for (auto& c : components) {
+                out << c.name << ": " << c.bytes << (c.owned ? "" : " (mapped)") << "\n";
+            }
+            out << "total: " << total_bytes() << " (owned " << owned_bytes()
+                << ", mapped " << mapped_bytes() << ")\n";
+            return out.str();
+        }
+    };
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_SPACE_REPORT_H
@@ -0,0 +1,136 @@
+//
+// Suffix-merged pool of the node tails of DefaultPathDecomposedTrie, see
+// `separate_tails()`.
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_TAIL_POOL_H
+#define PATH_DECOMPOSITION_TRIE_TAIL_POOL_H
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "bit_vector.h"
+#include "compact_vector.h"
+
+namespace succinct {
+    namespace trie {
+        //
+        // The tail of a node is the bytes of its labels after the last
+        // branching point (the WORD_EOF after them is implicit): they are
+        // only compared once the navigation is over, the pool keeps them
+        // out of the labels `index()` walks through.
+        //
+        // As in MARISA, a tail that is a suffix of another one is not stored
+        // again but points inside it: the tails are sorted by their reversed
+        // bytes, a tail is then a suffix of the one before it if it is one of
+        // any. `m_ends_` marks the last byte of every stored tail, which is
+        // also the last byte of the tails merged into it. The offset of the
+        // tail of each node is bit packed, `m_bytes_.size()` for no tail (the
+        // merging makes the offsets unsorted, Elias-Fano would not apply).
+        //
+        class TailPool {
+        public:
+            TailPool() {}
+
+            // `tails[v]`: the tail of node `v`, empty for none
+            explicit TailPool(const std::vector<std::string>& tails) {
+                std::vector<size_t> order;
+                for (size_t v = 0; v < tails.size(); ++v) {
+                    if (!tails[v].empty()) order.push_back(v);
+                }
+                // by reversed bytes, descending: a suffix right after the tails ending with it
+                auto reversed_greater = [&](size_t a, size_t b) {
+                    return std::lexicographical_compare(tails[b].rbegin(), tails[b].rend(),
+                                                        tails[a].rbegin(), tails[a].rend(),
+                                                        [](char l, char r) { return uint8_t(l) < uint8_t(r); });
+                };
+                std::sort(order.begin(), order.end(), reversed_greater);
+
+                std::vector<uint8_t> bytes;
+                std::vector<bool> ends;
+                std::vector<uint64_t> offsets(tails.size(), uint64_t(-1));
+                const std::string* prev = nullptr;
+                uint64_t prev_end = 0;
+                for (size_t v : order) {
+                    const std::string& t = tails[v];
+                    if (prev && t.size() <= prev->size() &&
+                        std::equal(t.rbegin(), t.rend(), prev->rbegin())) {
+                        offsets[v] = prev_end - t.size();
+                    } else {
+                        offsets[v] = bytes.size();
+                        bytes.insert(bytes.end(), t.begin(), t.end());
+                        ends.resize(bytes.size(), false);
+                        ends.back() = true;
+                        prev_end = bytes.size();
+                    }
+                    prev = &t;
+                }
+                for (auto& o : offsets) {
+                    if (o == uint64_t(-1)) o = bytes.size();
+                }
+                m_bytes_.steal(bytes);
+                BitVector ends_vec(ends);
+                m_ends_.swap(ends_vec);
+                CompactVector offsets_vec(offsets);
+                m_offsets_.swap(offsets_vec);
+            }
+
+            void swap(TailPool& other) {
+                m_bytes_.swap(other.m_bytes_);
+                m_ends_.swap(other.m_ends_);
+                m_offsets_.swap(other.m_offsets_);
+            }
+
+            bool empty() const {
+                return m_offsets_.empty();
+            }
+
+            inline bool has_tail(size_t node) const {
+                return m_offsets_[node] != m_bytes_.size();
+            }
+
+            // number of tail bytes stored, after the merging
+            size_t num_bytes() const {
+                return m_bytes_.size();
+            }
+
+            // the tail of `node` is `len` bytes from `*ptr`
+            inline void tail(size_t node, const uint8_t*& ptr, size_t& len) const {
+                uint64_t begin = m_offsets_[node];
+                uint64_t pos = begin;
+                unsigned long l;
+                while (!util::lsb(m_ends_.get_word(pos), l)) pos += 64;
+                ptr = m_bytes_.data() + begin;
+                len = pos + l + 1 - begin;
+            }
+
+            // `key[0, n)` is the tail of `node` followed by `eof`
+            inline bool equals(size_t node, const uint16_t* key, size_t n, uint16_t eof) const {
+                const uint8_t* ptr;
+                size_t len;
+                tail(node, ptr, len);
+                if (n != len + 1 || key[len] != eof) return false;
+                for (size_t i = 0; i < len; ++i) {
+                    if (key[i] != ptr[i]) return false;
+                }
+                return true;
+            }
+
+            SpaceReport space_report() const {
+                SpaceReport report;
+                report.add("bytes", m_bytes_);
+                report.add("ends", m_ends_.space_report());
+                report.add("offsets", m_offsets_.bytes(), m_offsets_.is_owned());
+                return report;
+            }
+
+        private:
+            mappable_vector<uint8_t> m_bytes_;
+            BitVector m_ends_;
+            CompactVector m_offsets_;
+        };
+    }
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_TAIL_POOL_H
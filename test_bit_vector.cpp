@@ -3,8 +3,13 @@
 //
 #include <gtest/gtest.h>
 #include <iostream>
+#include <random>
 #include "bit_vector.h"
 #include "rank_select_bit_vector.h"
+#include "interleaved_rank_select_bit_vector.h"
+#include "darray.h"
+#include "compact_vector.h"
+#include "permutation.h"
 
 succinct::RsBitVector seq012BitVector(const std::string& s) {
     succinct::BitVectorBuilder builder;
@@ -58,6 +63,192 @@ TEST(BIT_VECTOR_TEST, SELECT_1) {
     EXPECT_EQ(res, s.size() - 1);
 }
 
+TEST(BIT_VECTOR_TEST, SPACE_REPORT) {
+    succinct::BitVectorBuilder builder;
+    for (size_t i = 0; i < 100000; ++i) {
+        builder.push_back(i % 3 == 0);
+    }
+    succinct::RsBitVector rsBitVector(&builder, true, true);
+    succinct::SpaceReport report = rsBitVector.space_report();
+
+    EXPECT_EQ(report.bytes("bits"), (100000 + 63) / 64 * 8);
+    EXPECT_GT(report.bytes("block_rank_pairs"), 0);
+    EXPECT_GT(report.bytes("select_hints"), 0);
+    EXPECT_GT(report.bytes("select0_hints"), 0);
+    EXPECT_EQ(report.total_bytes(), report.owned_bytes());
+    EXPECT_EQ(report.mapped_bytes(), 0);
+
+    succinct::RsBitVector no_hints(std::vector<bool>(1000, true));
+    EXPECT_EQ(no_hints.space_report().bytes("select_hints"), 0);
+}
+
+template <typename T>
+class RS_BIT_VECTOR_CONFIG_TEST : public testing::Test {};
+
+typedef testing::Types<succinct::BasicRsBitVector<1>,
+                       succinct::BasicRsBitVector<2>,
+                       succinct::BasicRsBitVector<3, 200>,
+                       succinct::BasicRsBitVector<4>,
+                       succinct::BasicRsBitVector<7>,
+                       succinct::BasicRsBitVector<8, 4096>,
+                       succinct::InterleavedRsBitVector> RsBitVectorConfigs;
+TYPED_TEST_CASE(RS_BIT_VECTOR_CONFIG_TEST, RsBitVectorConfigs);
+
+// rank / select / select0 of every block size against a naive scan
+TYPED_TEST(RS_BIT_VECTOR_CONFIG_TEST, RANDOM) {
+    std::mt19937_64 rng(7);
+    for (size_t n : {1, 63, 64, 65, 448, 1000, 3136, 20011}) {
+        for (uint64_t density : {2, 10, 50, 98}) {
+            std::vector<bool> bits(n);
+            for (size_t i = 0; i < n; ++i) bits[i] = rng() % 100 < density;
+            TypeParam bv(bits, true, true);
+
+            std::vector<uint64_t> ones, zeros;
+            for (size_t i = 0; i < n; ++i) {
+                ASSERT_EQ(bv.rank(i), ones.size());
+                (bits[i] ? ones : zeros).push_back(i);
+            }
+            ASSERT_EQ(bv.rank(n), ones.size());
+            ASSERT_EQ(bv.num_ones(), ones.size());
+            for (size_t i = 0; i < ones.size(); ++i) ASSERT_EQ(bv.select(i), ones[i]);
+            for (size_t i = 0; i < zeros.size(); ++i) ASSERT_EQ(bv.select0(i), zeros[i]);
+        }
+    }
+}
+
+// the data words, the neighbour searches and the line layout against RsBitVector
+TEST(INTERLEAVED_RS_BIT_VECTOR, WORDS) {
+    std::mt19937_64 rng(3);
+    size_t n = 10000;
+    std::vector<bool> bits(n);
+    for (size_t i = 0; i < n; ++i) bits[i] = rng() % 4 == 0;
+    bits[0] = bits[1] = bits[n - 1] = false;
+    bits[2] = bits[n - 2] = true;
+    succinct::RsBitVector rs(bits);
+    succinct::InterleavedRsBitVector il(bits);
+    succinct::InterleavedRsBitVector mapped(rs.data().data(), rs.data().size(), n);
+
+    ASSERT_EQ(il.word_count(), rs.word_count());
+    for (uint64_t i = 0; i < il.word_count(); ++i) {
+        ASSERT_EQ(il.word_at(i), rs.word_at(i));
+        ASSERT_EQ(mapped.word_at(i), rs.word_at(i));
+        ASSERT_EQ(*il.word_ptr(i), rs.word_at(i));
+    }
+    // lines start on a cache line, the counter word first
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(il.word_ptr(0) - 1) % 64, 0);
+    for (size_t i = 0; i < n; ++i) {
+        ASSERT_EQ(il[i], bits[i]);
+        if (i >= 1) {
+            ASSERT_EQ(il.predecessor0(i), rs.predecessor0(i));
+        }
+        if (i < n - 1) {
+            ASSERT_EQ(il.successor0(i), rs.successor0(i));
+        }
+        if (i >= 2) {
+            ASSERT_EQ(il.predecessor1(i), rs.predecessor1(i));
+        }
+        if (i < n - 2) {
+            ASSERT_EQ(il.successor1(i), rs.successor1(i));
+        }
+    }
+    ASSERT_EQ(mapped.num_ones(), rs.num_ones());
+    // 1/7 of the data words for the counters
+    succinct::SpaceReport report = il.space_report();
+    EXPECT_EQ(report.bytes("line_counters") * 7, report.bytes("bits"));
+}
+
+// darray select against a naive scan, with sparse blocks stored as overflow positions
+TEST(DARRAY_TEST, RANDOM) {
+    std::mt19937_64 rng(13);
+    for (uint64_t density : {1, 30, 50, 70, 99}) {
+        size_t n = 300000;
+        std::vector<bool> bits(n);
+        for (size_t i = 0; i < n; ++i) bits[i] = rng() % 100 < density;
+        // a long run of a single value: the blocks spanning it are sparse
+        for (size_t i = 100000; i < 250000; ++i) bits[i] = density < 50;
+        succinct::RsBitVector bv(bits);
+        succinct::Darray1 d1(bv);
+        succinct::Darray0 d0(bv);
+
+        std::vector<uint64_t> ones, zeros;
+        for (size_t i = 0; i < n; ++i) (bits[i] ? ones : zeros).push_back(i);
+        ASSERT_EQ(d1.num_positions(), ones.size());
+        ASSERT_EQ(d0.num_positions(), zeros.size());
+        for (size_t i = 0; i < ones.size(); ++i) ASSERT_EQ(d1.select(bv, i), ones[i]);
+        for (size_t i = 0; i < zeros.size(); ++i) ASSERT_EQ(d0.select(bv, i), zeros[i]);
+        if (density == 1) {
+            EXPECT_GT(d1.space_report().bytes("overflow_positions"), 0);
+        }
+    }
+}
+
+TEST(COMPACT_VECTOR_TEST, RANDOM) {
+    std::mt19937_64 rng(19);
+    for (uint64_t width : {1, 7, 13, 31, 32, 33, 63, 64}) {
+        std::vector<uint64_t> values(1000);
+        uint64_t mask = width == 64 ? uint64_t(-1) : (1ULL << width) - 1;
+        for (auto& v : values) v = rng() & mask;
+        values[3] = mask;
+        succinct::CompactVector cv(values);
+        EXPECT_EQ(cv.width(), width);
+        ASSERT_EQ(cv.size(), values.size());
+        for (size_t i = 0; i < values.size(); ++i) ASSERT_EQ(cv[i], values[i]);
+    }
+    EXPECT_EQ(succinct::CompactVector(std::vector<uint64_t>{0, 0}).width(), 1);
+    EXPECT_EQ(succinct::CompactVector(std::vector<uint64_t>{1, 2}, 10).width(), 10);
+    EXPECT_TRUE(succinct::CompactVector().empty());
+}
+
+TEST(PERMUTATION_TEST, INVERSE) {
+    std::mt19937_64 rng(29);
+    for (size_t n : {0, 1, 2, 100, 5000}) {
+        std::vector<uint64_t> values(n);
+        for (size_t i = 0; i < n; ++i) values[i] = i;
+        std::shuffle(values.begin(), values.end(), rng);
+        // and one long cycle, the identity
+        std::vector<uint64_t> cycle(n), identity(n);
+        for (size_t i = 0; i < n; ++i) {
+            cycle[i] = (i + 1) % n;
+            identity[i] = i;
+        }
+        for (auto* perm : {&values, &cycle, &identity}) {
+            for (size_t step : {1, 3, 16, 10000}) {
+                succinct::Permutation p(*perm, step);
+                ASSERT_EQ(p.size(), n);
+                for (size_t i = 0; i < n; ++i) {
+                    ASSERT_EQ(p[i], (*perm)[i]);
+                    ASSERT_EQ(p.inverse((*perm)[i]), i) << "n " << n << " step " << step;
+                }
+            }
+        }
+    }
+    EXPECT_TRUE(succinct::Permutation().empty());
+}
+
+// the dispatched primitives (hardware with -march=native) against the broadword code
+TEST(BIT_UTIL_TEST, DISPATCH) {
+    std::mt19937_64 rng(7);
+    for (size_t i = 0; i < 100000; ++i) {
+        uint64_t x = rng();
+        if (i % 3 == 1) x &= rng();
+        if (i % 3 == 2) x >>= rng() % 64;
+        if (i < 64) x = 1ULL << i;
+        ASSERT_EQ(succinct::util::popcount(x), succinct::util::broadword_popcount(x));
+        unsigned long hw = 0, bw = 0;
+        ASSERT_EQ(succinct::util::msb(x, hw), succinct::util::broadword_msb(x, bw));
+        ASSERT_EQ(hw, bw);
+        ASSERT_EQ(succinct::util::lsb(x, hw), succinct::util::broadword_lsb(x, bw));
+        ASSERT_EQ(hw, bw);
+        uint64_t ones = succinct::util::broadword_popcount(x);
+        for (uint64_t k = 0; k < ones; k += 1 + rng() % 8) {
+            ASSERT_EQ(succinct::util::select_in_word(x, k), succinct::util::broadword_select_in_word(x, k));
+        }
+    }
+    unsigned long ret = 0;
+    EXPECT_FALSE(succinct::util::msb(0, ret));
+    EXPECT_FALSE(succinct::util::lsb(0, ret));
+}
+
 GTEST_API_ int main(int argc, char ** argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -2,6 +2,7 @@
 // Created by Dim Dew on 2020-07-28.
 //
 #include <gtest/gtest.h>
+#include <random>
 #include "balanced_parentheses_vector.h"
 
 TEST(FIND_OPEN, FIND_OPEN_IN_WORD_1) {
@@ -111,6 +112,153 @@ TEST(FIND_OPEN_BP_VECTOR, FIND_OPEN_1) {
     EXPECT_EQ(res, 11);
 }
 
+template <typename T>
+class BP_VECTOR_CONFIG_TEST : public testing::Test {};
+
+// the configurations instantiated in balanced_parentheses_vector.cpp
+typedef testing::Types<succinct::BpVector,
+                       succinct::BasicBpVector<succinct::RsBitVector, 2, 32>,
+                       succinct::BasicBpVector<succinct::RsBitVector, 8, 32>,
+                       succinct::BasicBpVector<succinct::RsBitVector, 4, 16>,
+                       succinct::BasicBpVector<succinct::RsBitVector, 4, 64>,
+                       succinct::BasicBpVector<succinct::BasicRsBitVector<4>, 4, 32>,
+                       succinct::BasicBpVector<succinct::InterleavedRsBitVector, 4, 32>> BpVectorConfigs;
+TYPED_TEST_CASE(BP_VECTOR_CONFIG_TEST, BpVectorConfigs);
+
+// find_close / find_open / excess_rmq against a naive scan on a random
+// balanced sequence long enough to go through the superblock min tree.
+TYPED_TEST(BP_VECTOR_CONFIG_TEST, RANDOM) {
+    std::mt19937_64 rng(11);
+    size_t n = 200000;
+    std::vector<bool> bits;
+    std::vector<uint64_t> stack, mate(n);
+    // deep excursions, so that mates are far apart
+    for (size_t i = 0; i < n; ++i) {
+        bool open = stack.empty() || (stack.size() < n - i && rng() % 1000 < (i / 5000 % 2 ? 400 : 600));
+        bits.push_back(open);
+        if (open) {
+            stack.push_back(i);
+        } else {
+            mate[stack.back()] = i;
+            mate[i] = stack.back();
+            stack.pop_back();
+        }
+    }
+    ASSERT_TRUE(stack.empty());
+    TypeParam bp(bits, true, true);
+
+    for (size_t i = 0; i < n; ++i) {
+        if (bits[i]) {
+            ASSERT_EQ(bp.find_close(i), mate[i]);
+        } else {
+            ASSERT_EQ(bp.find_open(i), mate[i]);
+        }
+    }
+
+    for (size_t q = 0; q < 300; ++q) {
+        uint64_t a = rng() % n;
+        uint64_t b = std::min<uint64_t>(n, a + rng() % (q % 3 ? 500 : 50000));
+        int64_t exc = 0, min_exc = 0;
+        for (size_t i = 0; i < a; ++i) exc += bits[i] ? 1 : -1;
+        min_exc = exc;
+        for (size_t i = a; i < b; ++i) {
+            exc += bits[i] ? 1 : -1;
+            min_exc = std::min(min_exc, exc);
+        }
+        typename TypeParam::excess_t found_exc;
+        uint64_t found = bp.excess_rmq(a, b, found_exc);
+        ASSERT_EQ(found_exc, min_exc);
+        ASSERT_EQ(bp.excess(found), min_exc);
+    }
+}
+
+// select0 from the darray, over both rank/select layouts
+TEST(DARRAY_BP_VECTOR, SELECT0) {
+    std::mt19937_64 rng(17);
+    std::vector<bool> bits;
+    size_t excess = 0;
+    for (size_t i = 0; i < 100000; ++i) {
+        bool open = excess == 0 || rng() % 2;
+        bits.push_back(open);
+        excess += open ? 1 : -1;
+    }
+    bits.insert(bits.end(), excess, false);
+    succinct::BpVector bp(bits, true, true);
+    succinct::DarrayBpVector<> darray_bp(bits, true, true);
+    succinct::DarrayBpVector<succinct::BasicBpVector<succinct::InterleavedRsBitVector>> interleaved_bp(bits, true, true);
+    ASSERT_EQ(darray_bp.num_zeros(), bp.num_zeros());
+    for (size_t i = 0; i < bp.num_zeros(); ++i) {
+        ASSERT_EQ(darray_bp.select0(i), bp.select0(i));
+        ASSERT_EQ(interleaved_bp.select0(i), bp.select0(i));
+    }
+    // the darray replaces the select0 hints
+    succinct::SpaceReport report = darray_bp.space_report();
+    EXPECT_EQ(report.bytes("select0_hints"), 0);
+    EXPECT_GT(report.bytes("select0_darray.block_inventory"), 0);
+    EXPECT_EQ(darray_bp.find_close(0), bp.find_close(0));
+}
+
+// every in-word kernel compiled in (see bp_word_kernel()) against the excess tables
+TEST(BP_WORD_KERNELS, CROSS_CHECK) {
+    typedef bool (*find_fn)(uint64_t, uint64_t, succinct::BpVector::excess_t, uint64_t&);
+    typedef void (*rmq_fn)(uint64_t, succinct::BpVector::excess_t&, uint64_t,
+                           succinct::BpVector::excess_t&, uint64_t&);
+    std::vector<std::pair<find_fn, find_fn>> finds = {
+            {succinct::find_open_in_word, succinct::find_close_in_word}};
+    std::vector<rmq_fn> rmqs = {succinct::excess_rmq_in_word};
+#ifdef PDT_HW_AVX2
+    finds.emplace_back(succinct::avx2_find_open_in_word, succinct::avx2_find_close_in_word);
+    rmqs.push_back(succinct::avx2_excess_rmq_in_word);
+#endif
+#ifdef PDT_HW_AVX512BW
+    finds.emplace_back(succinct::avx512_find_open_in_word, succinct::avx512_find_close_in_word);
+    rmqs.push_back(succinct::avx512_excess_rmq_in_word);
+#endif
+
+    std::mt19937_64 rng(5);
+    for (size_t i = 0; i < 20000; ++i) {
+        uint64_t word = rng();
+        // biased words, so that deep excesses are reached
+        if (i % 4 == 1) word |= rng() | rng();
+        if (i % 4 == 2) word &= rng() & rng();
+        if (i % 4 == 3) word = i % 8 == 3 ? 0 : ~0ULL;
+        uint64_t byte_counts = succinct::util::byte_counts(word);
+
+        for (succinct::BpVector::excess_t exc = 1; exc <= 64; ++exc) {
+            uint64_t expected = -1ULL, ret = -1ULL;
+            bool found = succinct::table_find_open_in_word(word, byte_counts, exc, expected);
+            for (auto& f : finds) {
+                ASSERT_EQ(f.first(word, byte_counts, exc, ret), found);
+                if (found) {
+                    ASSERT_EQ(ret, expected);
+                }
+            }
+            found = succinct::table_find_close_in_word(word, byte_counts, exc, expected);
+            for (auto& f : finds) {
+                ASSERT_EQ(f.second(word, byte_counts, exc, ret), found);
+                if (found) {
+                    ASSERT_EQ(ret, expected);
+                }
+            }
+        }
+
+        // the running minimum is at, below or above the excess at the word start
+        succinct::BpVector::excess_t start = static_cast<succinct::BpVector::excess_t>(rng() % 200) - 100;
+        succinct::BpVector::excess_t start_min = start - static_cast<succinct::BpVector::excess_t>(rng() % 70) + 3;
+        succinct::BpVector::excess_t exc = start, min_exc = start_min;
+        uint64_t min_idx = 7;
+        succinct::table_excess_rmq_in_word(word, exc, 128, min_exc, min_idx);
+        for (auto rmq : rmqs) {
+            succinct::BpVector::excess_t e = start, m = start_min;
+            uint64_t idx = 7;
+            rmq(word, e, 128, m, idx);
+            ASSERT_EQ(e, exc);
+            ASSERT_EQ(m, min_exc);
+            ASSERT_EQ(idx, min_idx);
+        }
+    }
+}
+
 GTEST_API_ int main(int argc, char ** argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -59,6 +59,25 @@ TEST(BP_VECTOR_ENCODE_DECODE, TEST_1) {
     EXPECT_EQ(encode, encode_copy);
 }
 
+TEST(BP_VECTOR_ENCODE_DECODE, SPACE_REPORT) {
+    std::string s;
+    for (int i = 0; i < 1000; ++i) s += "(()())";
+    succinct::BpVector bpVector = parentheses2BpVector(s);
+    succinct::SpaceReport owned = bpVector.space_report();
+    EXPECT_EQ(owned.bytes("bits"), bpVector.data().size() * sizeof(uint64_t));
+    EXPECT_GT(owned.bytes("block_excess_min"), 0);
+    EXPECT_GT(owned.bytes("superblock_excess_min"), 0);
+    EXPECT_EQ(owned.mapped_bytes(), 0);
+
+    // the decoded vector maps the bits and builds its own directories
+    std::vector<uint64_t> encode(bpVector.data().begin(), bpVector.data().end());
+    succinct::BpVector bpVector2(encode.data(), encode.size(), bpVector.size());
+    succinct::SpaceReport mapped = bpVector2.space_report();
+    EXPECT_EQ(mapped.total_bytes(), owned.total_bytes());
+    EXPECT_EQ(mapped.mapped_bytes(), owned.bytes("bits"));
+    EXPECT_EQ(mapped.owned_bytes(), owned.total_bytes() - owned.bytes("bits"));
+}
+
 GTEST_API_ int main(int argc, char ** argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
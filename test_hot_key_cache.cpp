@@ -0,0 +1,98 @@
+//
+// HotKeyCache of hot_key_cache.h
+//
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+#include "hot_key_cache.h"
+#include "test_trie_util.h"
+
+typedef succinct::trie::DefaultPathDecomposedTrie<false> trie_t;
+typedef succinct::trie::HotKeyCache<trie_t> cache_t;
+
+TEST(HOT_KEY_CACHE_TEST, HITS_AND_MISSES) {
+    auto keys = random_keys(2000, 1);
+    auto pdt = build_trie<false>(keys);
+    cache_t cache(*pdt, 4096);
+    EXPECT_EQ(cache.capacity(), 64 * cache_t::WAYS);
+    EXPECT_EQ(cache.space_report().total_bytes(), 4096);
+
+    // a hot key: one miss, then hits
+    for (int i = 0; i < 10; ++i) EXPECT_EQ(cache.index(keys[7]), pdt->index(keys[7]));
+    EXPECT_EQ(cache.stats().hits, 9);
+    EXPECT_EQ(cache.stats().misses, 1);
+    // absent keys are cached too
+    for (int i = 0; i < 3; ++i) EXPECT_EQ(cache.index(keys[7] + "~"), -1);
+    EXPECT_EQ(cache.stats().hits, 11);
+
+    // more keys than slots: evictions, never a wrong result
+    for (int round = 0; round < 3; ++round) {
+        for (auto& k : keys) {
+            ASSERT_EQ(cache.index(k), pdt->index(k));
+            ASSERT_EQ(cache.index(k + "z"), pdt->index(k + "z"));
+        }
+    }
+    auto s = cache.stats();
+    EXPECT_EQ(s.hits + s.misses, 13 + 3 * 2 * keys.size());
+
+    cache.reset_stats();
+    cache.clear();
+    cache.index(keys[0]);
+    EXPECT_EQ(cache.stats().misses, 1);
+    EXPECT_EQ(cache.stats().hits, 0);
+}
+
+// two hot keys that the hash would send to the same way of a full set
+// still end up both cached
+TEST(HOT_KEY_CACHE_TEST, RANDOM_REPLACEMENT) {
+    auto keys = random_keys(200, 2);
+    auto pdt = build_trie<false>(keys);
+    cache_t cache(*pdt, 64);
+    ASSERT_EQ(cache.capacity(), size_t(cache_t::WAYS));
+    std::vector<std::string> pair;
+    for (size_t i = cache_t::WAYS; i < keys.size() && pair.size() < 2; ++i) {
+        if (pair.empty() || cache_t::hash_key(keys[i]) >> 62 == cache_t::hash_key(pair[0]) >> 62) {
+            pair.push_back(keys[i]);
+        }
+    }
+    ASSERT_EQ(pair.size(), 2);
+    for (size_t i = 0; i < cache_t::WAYS; ++i) cache.index(keys[i]);
+    cache.reset_stats();
+    for (int i = 0; i < 100; ++i) {
+        for (auto& k : pair) ASSERT_EQ(cache.index(k), pdt->index(k));
+    }
+    EXPECT_GT(cache.stats().hits, 100);
+}
+
+// many readers on one const trie and one cache, skewed keys
+TEST(HOT_KEY_CACHE_TEST, THREADS) {
+    auto keys = random_keys(5000, 2);
+    auto pdt = build_trie<false>(keys);
+    std::vector<int> expected;
+    for (auto& k : keys) expected.push_back(pdt->index(k));
+    cache_t cache(*pdt, 1 << 14);
+
+    const size_t n_threads = 8, n_queries = 20000;
+    std::vector<size_t> errors(n_threads, 0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < n_threads; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937_64 rng(t);
+            for (size_t i = 0; i < n_queries; ++i) {
+                // a quarter of the queries on 16 keys, the rest uniform
+                size_t k = rng() % 4 ? rng() % keys.size() : rng() % 16;
+                if (cache.index(keys[k]) != expected[k]) ++errors[t];
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    for (size_t t = 0; t < n_threads; ++t) EXPECT_EQ(errors[t], 0);
+    auto s = cache.stats();
+    EXPECT_EQ(s.hits + s.misses, n_threads * n_queries);
+    EXPECT_GT(s.hits, n_threads * n_queries / 5);
+}
+
+GTEST_API_ int main(int argc, char ** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,82 @@
+//
+// KeyEncoder of key_encoder.h
+//
+#include <gtest/gtest.h>
+#include <random>
+#include "key_encoder.h"
+
+static std::vector<std::string> hex_keys(size_t n, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < n; ++i) {
+        std::string s = "id:";
+        for (size_t j = 0; j < 16; ++j) s += "0123456789abcdef"[rng() % 16];
+        keys.push_back(s);
+    }
+    return keys;
+}
+
+// sorted distinct keys stay sorted and distinct, and decode back
+static void check_order(const succinct::trie::KeyEncoder& encoder, std::vector<std::string> keys) {
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    std::string prev;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        std::string code = encoder.encode(keys[i]);
+        if (i) {
+            ASSERT_LT(prev, code) << keys[i - 1] << " / " << keys[i];
+        }
+        std::vector<uint8_t> decoded;
+        encoder.decode(reinterpret_cast<const uint8_t*>(code.data()), code.size(), decoded);
+        ASSERT_EQ(std::string(decoded.begin(), decoded.end()), keys[i]);
+        prev = code;
+    }
+}
+
+TEST(KEY_ENCODER_TEST, ORDER_AND_ROUND_TRIP) {
+    std::vector<std::string> sample = hex_keys(2000, 1);
+    std::mt19937_64 rng(2);
+    // keys off the sample: other bytes, NULs, prefixes of the bigrams
+    std::vector<std::string> keys = hex_keys(2000, 3);
+    for (size_t i = 0; i < 3000; ++i) {
+        std::string s;
+        size_t len = rng() % 6;
+        for (size_t j = 0; j < len; ++j) {
+            s += rng() % 2 ? "0af:i\xff"[rng() % 6] : char(rng() % 256);
+        }
+        keys.push_back(s);
+    }
+    keys.push_back("");
+    keys.push_back(std::string(3, '\0'));
+    for (size_t max_codes : {size_t(2), size_t(16), size_t(100), succinct::trie::KeyEncoder::MAX_CODES}) {
+        succinct::trie::KeyEncoder encoder(sample, max_codes);
+        EXPECT_LE(encoder.num_codes(), max_codes);
+        check_order(encoder, keys);
+    }
+    // every byte of a sample over the whole alphabet
+    std::vector<std::string> all_bytes;
+    for (size_t c = 0; c < 256; ++c) all_bytes.push_back(std::string(2, char(c)));
+    succinct::trie::KeyEncoder encoder(all_bytes);
+    EXPECT_EQ(encoder.num_codes(), 256);
+    check_order(encoder, keys);
+}
+
+TEST(KEY_ENCODER_TEST, SHRINKS_SAMPLE_KEYS) {
+    std::vector<std::string> sample = hex_keys(5000, 4);
+    succinct::trie::KeyEncoder encoder(sample);
+    EXPECT_EQ(encoder.num_codes(), size_t(succinct::trie::KeyEncoder::MAX_CODES));
+    size_t raw = 0, encoded = 0;
+    for (auto& key : hex_keys(1000, 5)) {
+        raw += key.size();
+        encoded += encoder.encode(key).size();
+    }
+    EXPECT_LT(encoded * 10, raw * 7);
+
+    succinct::trie::KeyEncoder identity;
+    EXPECT_TRUE(identity.empty());
+}
+
+GTEST_API_ int main(int argc, char ** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -2,7 +2,9 @@
 // Created by Dim Dew on 2020-10-09.
 //
 #include <gtest/gtest.h>
-#include "path_decomposed_trie.h"
+#include <random>
+#include <set>
+#include "test_trie_util.h"
 
 std::vector<uint8_t> string_to_bytes(std::string s) {
     return std::vector<uint8_t>(s.begin(), s.end());
@@ -303,6 +305,575 @@ TEST(PDT_TEST, INDEX_3) {
     }
 }
 
+TEST(PDT_TEST, INDEX_HIGH_BYTES) {
+    succinct::DefaultTreeBuilder<> pdt_builder;
+    succinct::trie::compacted_trie_builder
+            <succinct::DefaultTreeBuilder<>>
+            trieBuilder(pdt_builder);
+    std::vector<std::string> strs{std::string("a\x00\x01", 3), "a\x7f", "a\x80\x90",
+                                  "a\xfe", "\xff\xff\x01", "\xff\xff\xf0"};
+    for (auto s : strs) {
+        append_to_trie(trieBuilder, s);
+    }
+    trieBuilder.finish();
+
+    succinct::trie::DefaultPathDecomposedTrie<> pdt(trieBuilder);
+
+    for (auto& s : strs) {
+        EXPECT_NE(pdt.index(s), -1);
+    }
+    EXPECT_EQ(pdt.index("a\x80"), -1);
+    EXPECT_EQ(pdt.index("\xff\xff"), -1);
+}
+
+TEST(PDT_TEST, BRANCH_SEARCH) {
+    std::mt19937_64 rng(3);
+    for (size_t n = 0; n < 300; ++n) {
+        // a strictly decreasing run, as in the lexicographic trie
+        std::vector<uint16_t> run;
+        for (int c = 1024; c >= 0 && run.size() < n; --c) {
+            if (c <= 255 || c == 1024) {
+                if (rng() % 2 || 256 - c < int(n)) run.push_back(uint16_t(c));
+            }
+        }
+        for (int c = 0; c <= 1024; c += (c < 256 ? 1 : 768)) {
+            size_t expected = std::find(run.begin(), run.end(), c) - run.begin();
+            ASSERT_EQ(succinct::trie::scan_branches(run.data(), run.size(), uint16_t(c)), expected);
+            ASSERT_EQ(succinct::trie::search_sorted_branches(run.data(), run.size(), uint16_t(c)), expected);
+            ASSERT_EQ(succinct::trie::find_branch<true>(run.data(), run.size(), uint16_t(c)), expected);
+        }
+        std::shuffle(run.begin(), run.end(), rng);
+        for (int c = 0; c <= 1024; c += (c < 256 ? 1 : 768)) {
+            size_t expected = std::find(run.begin(), run.end(), c) - run.begin();
+            ASSERT_EQ(succinct::trie::find_branch<false>(run.data(), run.size(), uint16_t(c)), expected);
+        }
+    }
+}
+
+// nodes with up to 256 light branches, searched by both decompositions
+template <bool Lexicographic, typename BpVectorType = succinct::BpVector>
+void check_wide_nodes(bool navigation = false, size_t top_level_budget = 0) {
+    std::mt19937_64 rng(Lexicographic);
+    std::vector<std::string> strs;
+    for (int a = 0; a < 256; a += 1 + rng() % 3) {
+        strs.push_back(std::string(1, char(a)));
+        for (int b = 0; b < 256; b += 1 + rng() % (a % 2 ? 2 : 40)) {
+            strs.push_back(std::string(1, char(a)) + char(b));
+        }
+    }
+    std::sort(strs.begin(), strs.end(), [](const std::string& x, const std::string& y) {
+        return std::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end(),
+                [](char l, char r) { return uint8_t(l) < uint8_t(r); });
+    });
+
+    succinct::DefaultTreeBuilder<Lexicographic> pdt_builder;
+    succinct::trie::compacted_trie_builder
+            <succinct::DefaultTreeBuilder<Lexicographic>>
+            trieBuilder(pdt_builder);
+    for (auto& s : strs) {
+        append_to_trie(trieBuilder, s);
+    }
+    trieBuilder.finish();
+    succinct::trie::DefaultPathDecomposedTrie<Lexicographic, BpVectorType> pdt(trieBuilder);
+    if (navigation) pdt.build_navigation_index();
+    if (top_level_budget) pdt.build_top_level_table(top_level_budget);
+
+    std::set<std::string> keys(strs.begin(), strs.end());
+    std::set<int> indexes;
+    for (auto& s : strs) {
+        int idx = pdt.index(s);
+        ASSERT_NE(idx, -1);
+        ASSERT_EQ(pdt[idx], std::vector<uint8_t>(s.begin(), s.end()));
+        indexes.insert(idx);
+        if (!keys.count(s + char(1))) {
+            ASSERT_EQ(pdt.index(s + char(1)), -1);
+        }
+    }
+    EXPECT_EQ(indexes.size(), strs.size());
+}
+
+TEST(PDT_TEST, INDEX_WIDE_NODES) {
+    check_wide_nodes<true>();
+    check_wide_nodes<false>();
+}
+
+// the BP on the rank counters interleaved with the bits
+TEST(PDT_TEST, INDEX_INTERLEAVED_BP) {
+    typedef succinct::BasicBpVector<succinct::InterleavedRsBitVector> bp_t;
+    check_wide_nodes<true, bp_t>();
+    check_wide_nodes<false, bp_t>();
+}
+
+// index() through the navigation arrays
+TEST(PDT_TEST, INDEX_NAVIGATION) {
+    check_wide_nodes<true>(true);
+    check_wide_nodes<false>(true);
+
+    succinct::DefaultTreeBuilder<true> pdt_builder;
+    succinct::trie::compacted_trie_builder
+            <succinct::DefaultTreeBuilder<true>>
+            trieBuilder(pdt_builder);
+    std::vector<std::string> strs = {"three", "trial", "triangle", "trie", "tried", "zoo"};
+    for (auto& s : strs) append_to_trie(trieBuilder, s);
+    trieBuilder.finish();
+    succinct::trie::DefaultPathDecomposedTrie<true> pdt(trieBuilder);
+    std::vector<int> expected;
+    for (auto& s : strs) expected.push_back(pdt.index(s));
+    uint64_t bytes = pdt.space_report().total_bytes();
+
+    pdt.build_navigation_index();
+    ASSERT_TRUE(pdt.has_navigation_index());
+    EXPECT_EQ(pdt.m_nav.first_branch.size(), pdt.get_bp().num_zeros() + 1);
+    for (size_t i = 0; i < strs.size(); ++i) {
+        EXPECT_EQ(pdt.index(strs[i]), expected[i]);
+        succinct::trie::Trace trace;
+        EXPECT_EQ(pdt.index_traced(strs[i], trace), expected[i]);
+    }
+    EXPECT_EQ(pdt.index("tri"), -1);
+    EXPECT_EQ(pdt.index("triangles"), -1);
+    succinct::SpaceReport report = pdt.space_report();
+    EXPECT_GT(report.bytes("navigation.child"), 0);
+    EXPECT_EQ(report.total_bytes(), bytes + pdt.m_nav.space_report().total_bytes());
+
+    pdt.clear_navigation_index();
+    EXPECT_FALSE(pdt.has_navigation_index());
+    EXPECT_EQ(pdt.space_report().total_bytes(), bytes);
+}
+
+// index() from the top-level table, keys shorter than, as long as and longer
+// than its prefix
+TEST(PDT_TEST, INDEX_TOP_LEVEL) {
+    for (size_t budget : {size_t(3) << 10, size_t(768) << 10}) {
+        check_wide_nodes<true>(false, budget);
+        check_wide_nodes<false>(false, budget);
+        check_wide_nodes<false>(true, budget);
+    }
+
+    succinct::DefaultTreeBuilder<true> pdt_builder;
+    succinct::trie::compacted_trie_builder
+            <succinct::DefaultTreeBuilder<true>>
+            trieBuilder(pdt_builder);
+    std::vector<std::string> strs = {"a", "three", "trial", "triangle", "trie", "tried", "zoo"};
+    for (auto& s : strs) append_to_trie(trieBuilder, s);
+    trieBuilder.finish();
+    succinct::trie::DefaultPathDecomposedTrie<true> pdt(trieBuilder);
+    std::vector<std::string> queries = {"", "a", "ab", "t", "tr", "tri", "trie", "tried", "triangles",
+                                        "zo", "zoo", "zoom", "x", "xyz"};
+    std::vector<int> expected;
+    for (auto& s : queries) expected.push_back(pdt.index(s));
+    uint64_t bytes = pdt.space_report().total_bytes();
+
+    EXPECT_EQ(pdt.build_top_level_table(1000), 0u);
+    EXPECT_FALSE(pdt.has_top_level_table());
+    EXPECT_EQ(pdt.build_top_level_table(1 << 20), 2u);
+    ASSERT_TRUE(pdt.has_top_level_table());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        EXPECT_EQ(pdt.index(queries[i]), expected[i]) << queries[i];
+        succinct::trie::Trace trace;
+        EXPECT_EQ(pdt.index_traced(queries[i], trace), expected[i]);
+    }
+    succinct::SpaceReport report = pdt.space_report();
+    EXPECT_EQ(report.bytes("top_level.nodes"), (1u << 16) * sizeof(uint32_t));
+    EXPECT_EQ(report.total_bytes(), bytes + (1u << 16) * succinct::trie::TopLevelTable::entry_bytes());
+
+    pdt.clear_top_level_table();
+    EXPECT_FALSE(pdt.has_top_level_table());
+    EXPECT_EQ(pdt.space_report().total_bytes(), bytes);
+}
+
+// index_sorted_batch() against index(), sorted and shuffled batches
+template <bool Lexicographic>
+void check_sorted_batch(bool navigation) {
+    std::mt19937_64 rng(7);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 3000; ++i) keys.push_back(random_key(rng, 14, "abcdef", 3, 2));
+    sort_unique(keys);
+    auto trie = build_trie<Lexicographic>(keys);
+    auto& pdt = *trie;
+    if (navigation) pdt.build_navigation_index();
+
+    // present keys, their prefixes and extensions, duplicates, the empty key
+    std::vector<std::string> queries = {""};
+    for (size_t i = 0; i < 4000; ++i) {
+        const std::string& k = keys[rng() % keys.size()];
+        switch (rng() % 4) {
+            case 0: queries.push_back(k); break;
+            case 1: queries.push_back(k.substr(0, rng() % (k.size() + 1))); break;
+            case 2: queries.push_back(k + char('a' + rng() % 6)); break;
+            default: queries.push_back(k); queries.push_back(k); break;
+        }
+    }
+    for (int sorted = 1; sorted >= 0; --sorted) {
+        if (sorted) std::sort(queries.begin(), queries.end());
+        else std::shuffle(queries.begin(), queries.end(), rng);
+        std::vector<int> ids = pdt.index_sorted_batch(queries);
+        ASSERT_EQ(ids.size(), queries.size());
+        for (size_t i = 0; i < queries.size(); ++i) {
+            ASSERT_EQ(ids[i], pdt.index(queries[i])) << queries[i];
+        }
+    }
+    EXPECT_TRUE(pdt.index_sorted_batch(std::vector<std::string>()).empty());
+}
+
+TEST(PDT_TEST, INDEX_SORTED_BATCH) {
+    check_sorted_batch<true>(false);
+    check_sorted_batch<false>(false);
+    check_sorted_batch<false>(true);
+}
+
+// Re-Pair compressed labels: same index() and operator[] as the raw ones
+template <bool Lexicographic>
+void check_repair_labels() {
+    std::mt19937_64 rng(11);
+    std::vector<std::string> parts = {"http://", "www.", "example", ".com/", "index", ".html", "?id=", "/a/"};
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 3000; ++i) {
+        std::string s;
+        size_t n = 1 + rng() % 6;
+        for (size_t j = 0; j < n; ++j) s += parts[rng() % parts.size()];
+        s += std::to_string(rng() % 100);
+        keys.push_back(s);
+    }
+    sort_unique(keys);
+    auto raw_trie = build_trie<Lexicographic>(keys);
+    auto trie = build_trie<Lexicographic>(keys, succinct::trie::LabelEncoding::REPAIR);
+    auto& raw = *raw_trie;
+    auto& pdt = *trie;
+    ASSERT_TRUE(pdt.has_compressed_labels());
+    EXPECT_EQ(pdt.m_labels.size(), 0);
+    EXPECT_THROW(pdt.get_labels(), std::runtime_error);
+    EXPECT_EQ(pdt.label_count(), raw.get_labels().size());
+    EXPECT_GT(pdt.m_repair_labels.num_rules(), 0);
+    succinct::SpaceReport report = pdt.space_report();
+    EXPECT_EQ(report.bytes("labels"), 0);
+    EXPECT_LT(pdt.m_repair_labels.space_report().total_bytes(), raw.get_labels().size() * sizeof(uint16_t) / 2);
+
+    std::vector<std::string> queries;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        int idx = pdt.index(keys[i]);
+        ASSERT_EQ(idx, raw.index(keys[i]));
+        ASSERT_NE(idx, -1);
+        ASSERT_EQ(pdt[idx], raw[idx]);
+        ASSERT_EQ(pdt.index(keys[i] + "x"), raw.index(keys[i] + "x"));
+        ASSERT_EQ(pdt.index(keys[i].substr(0, i % keys[i].size())), raw.index(keys[i].substr(0, i % keys[i].size())));
+        queries.push_back(keys[i]);
+        queries.push_back(keys[i].substr(0, i % keys[i].size()));
+    }
+    succinct::trie::Trace trace;
+    EXPECT_EQ(pdt.index_traced(keys[5], trace), raw.index(keys[5]));
+
+    // with the other lookup structures
+    std::sort(queries.begin(), queries.end());
+    std::vector<int> expected = raw.index_sorted_batch(queries);
+    EXPECT_EQ(pdt.index_sorted_batch(queries), expected);
+    pdt.build_navigation_index();
+    pdt.build_top_level_table(1 << 20);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        ASSERT_EQ(pdt.index(queries[i]), expected[i]);
+    }
+}
+
+TEST(PDT_TEST, INDEX_REPAIR_LABELS) {
+    check_repair_labels<true>();
+    check_repair_labels<false>();
+}
+
+// each key, the key with one more byte (`extension` and the next two), a
+// prefix of it and the key with one byte changed
+std::vector<std::string> key_queries(const std::vector<std::string>& keys, char extension) {
+    std::vector<std::string> queries;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const std::string& k = keys[i];
+        queries.push_back(k);
+        queries.push_back(k + char(extension + i % 3));
+        queries.push_back(k.substr(0, i % (k.size() + 1)));
+        std::string changed = k;
+        changed[i % k.size()] ^= 1;
+        queries.push_back(changed);
+    }
+    return queries;
+}
+
+// tails in the pool: same index() and operator[] as the raw labels
+template <bool Lexicographic>
+void check_tails(succinct::trie::LabelEncoding encoding) {
+    std::mt19937_64 rng(13);
+    std::vector<std::string> suffixes = {"ing", "tion", "s", "ed", "", "ness", "ings"};
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 3000; ++i) {
+        std::string s = random_key(rng, 8, "abcdefghij", 2, 3);
+        keys.push_back(s + suffixes[rng() % suffixes.size()]);
+    }
+    keys.push_back(std::string("\0\xff", 2));
+    sort_unique(keys);
+    auto raw_trie = build_trie<Lexicographic>(keys);
+    auto trie = build_trie<Lexicographic>(keys, encoding);
+    auto& raw = *raw_trie;
+    auto& pdt = *trie;
+    ASSERT_TRUE(pdt.has_tails());
+    EXPECT_THROW(pdt.get_labels(), std::runtime_error);
+    EXPECT_LT(pdt.label_count(), raw.label_count());
+    EXPECT_GT(pdt.space_report().bytes("tails.bytes"), 0);
+    // the merged suffixes are stored once
+    size_t tail_bytes = 0;
+    for (size_t v = 0; v + 1 < pdt.word_positions.size(); ++v) {
+        if (!pdt.m_tails.has_tail(v)) continue;
+        const uint8_t* tail;
+        size_t len;
+        pdt.m_tails.tail(v, tail, len);
+        tail_bytes += len;
+    }
+    EXPECT_LT(pdt.m_tails.num_bytes(), tail_bytes);
+
+    std::vector<std::string> queries = key_queries(keys, 'a');
+    for (auto& q : queries) {
+        int idx = pdt.index(q);
+        ASSERT_EQ(idx, raw.index(q)) << q;
+        if (idx >= 0) {
+            ASSERT_EQ(pdt[idx], raw[idx]);
+        }
+    }
+    succinct::trie::Trace trace;
+    EXPECT_EQ(pdt.index_traced(keys[3], trace), raw.index(keys[3]));
+
+    std::sort(queries.begin(), queries.end());
+    std::vector<int> expected = raw.index_sorted_batch(queries);
+    EXPECT_EQ(pdt.index_sorted_batch(queries), expected);
+    for (size_t budget : {size_t(3) << 10, size_t(768) << 10}) {
+        pdt.build_top_level_table(budget);
+        for (size_t i = 0; i < queries.size(); ++i) {
+            ASSERT_EQ(pdt.index(queries[i]), expected[i]) << queries[i];
+        }
+    }
+}
+
+TEST(PDT_TEST, INDEX_TAILS) {
+    check_tails<true>(succinct::trie::LabelEncoding::TAIL);
+    check_tails<false>(succinct::trie::LabelEncoding::TAIL);
+    check_tails<false>(succinct::trie::LabelEncoding::TAIL_REPAIR);
+}
+
+// keys through a KeyEncoder: the same keys found as without, fewer labels (the
+// ids follow the shape of the encoded trie)
+template <bool Lexicographic>
+void check_key_encoder() {
+    std::mt19937_64 rng(19);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 3000; ++i) {
+        std::string s = i % 2 ? "/usr/lib/" : "id:";
+        keys.push_back(s + random_key(rng, 10, "0123456789abcdef", 2, 3));
+    }
+    keys.push_back(std::string("\0\xff", 2));
+    keys.push_back("~");
+    sort_unique(keys);
+    // the keys off the sample are escaped
+    std::vector<std::string> sample(keys.begin(), keys.begin() + keys.size() / 2);
+    succinct::trie::KeyEncoder encoder(sample);
+
+    auto raw_trie = build_trie<Lexicographic>(keys);
+    auto trie = build_trie<Lexicographic>(keys, succinct::trie::LabelEncoding::RAW, &encoder);
+    auto tailed_trie = build_trie<Lexicographic>(keys, succinct::trie::LabelEncoding::TAIL, &encoder);
+    auto& raw = *raw_trie;
+    auto& pdt = *trie;
+    auto& tailed = *tailed_trie;
+    EXPECT_LT(pdt.label_count(), raw.label_count());
+    EXPECT_GT(pdt.space_report().bytes("key_encoder.bounds"), 0);
+
+    std::vector<std::string> queries = key_queries(keys, '0');
+    std::set<int> ids;
+    for (auto& q : queries) {
+        int idx = pdt.index(q);
+        ASSERT_EQ(idx >= 0, raw.index(q) >= 0) << q;
+        ASSERT_EQ(tailed.index(q), idx) << q;
+        if (idx >= 0) {
+            ASSERT_EQ(pdt[idx], string_to_bytes(q));
+            ASSERT_EQ(tailed[idx], string_to_bytes(q));
+        }
+    }
+    for (auto& k : keys) ids.insert(pdt.index(k));
+    EXPECT_EQ(ids.size(), keys.size());
+
+    std::sort(queries.begin(), queries.end());
+    std::vector<int> expected;
+    for (auto& q : queries) expected.push_back(pdt.index(q));
+    EXPECT_EQ(pdt.index_sorted_batch(queries), expected);
+    pdt.build_top_level_table(size_t(768) << 10);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        ASSERT_EQ(pdt.index(queries[i]), expected[i]) << queries[i];
+    }
+}
+
+TEST(PDT_TEST, INDEX_KEY_ENCODER) {
+    check_key_encoder<true>();
+    check_key_encoder<false>();
+}
+
+// the raw encoding: the decoding constructor over get_labels(),
+// get_branches(), get_bp() and word_positions finds the same keys; a trie
+// with a key encoder cannot be encoded this way
+template <bool Lexicographic>
+void check_raw_encoding() {
+    std::mt19937_64 rng(37);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 2000; ++i) keys.push_back(random_key(rng, 10, "abcdefgh", 2, 3));
+    sort_unique(keys);
+    auto trie = build_trie<Lexicographic>(keys);
+    const auto& labels = trie->get_labels();
+    const auto& branches = trie->get_branches();
+    const auto& bp = trie->get_bp();
+    succinct::trie::DefaultPathDecomposedTrie<Lexicographic> decoded(
+            labels.data(), labels.size(), branches.data(), branches.size(),
+            bp.data().data(), bp.data().size(), bp.size(),
+            trie->word_positions.data(), trie->word_positions.size());
+    for (auto& k : keys) {
+        int idx = trie->index(k);
+        ASSERT_EQ(decoded.index(k), idx) << k;
+        ASSERT_EQ(decoded[idx], string_to_bytes(k));
+        ASSERT_EQ(decoded.index(k + "x"), -1);
+    }
+
+    std::vector<std::string> sample(keys.begin(), keys.begin() + keys.size() / 2);
+    succinct::trie::KeyEncoder encoder(sample);
+    auto encoded = build_trie<Lexicographic>(keys, succinct::trie::LabelEncoding::RAW, &encoder);
+    EXPECT_THROW(encoded->get_labels(), std::runtime_error);
+}
+
+TEST(PDT_TEST, RAW_ENCODING) {
+    check_raw_encoding<true>();
+    check_raw_encoding<false>();
+}
+
+// rank(): the position in the sorted key set for both decompositions
+template <bool Lexicographic>
+void check_rank(succinct::trie::LabelEncoding encoding) {
+    std::mt19937_64 rng(23);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 3000; ++i) keys.push_back(random_key(rng, 8, "ab\x7f\x80\xff", 2, 2));
+    sort_unique(keys);
+    auto trie = build_trie<Lexicographic>(keys, encoding);
+    auto& pdt = *trie;
+    EXPECT_EQ(pdt.has_rank_index(), Lexicographic);
+    pdt.build_rank_index();
+    ASSERT_TRUE(pdt.has_rank_index());
+    EXPECT_EQ(pdt.space_report().bytes("ranks.values") > 0, !Lexicographic);
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        ASSERT_EQ(pdt.rank(keys[i]), int(i)) << keys[i];
+        ASSERT_EQ(pdt.rank(keys[i] + "c"), -1);
+    }
+    pdt.clear_rank_index();
+    EXPECT_EQ(pdt.has_rank_index(), Lexicographic);
+}
+
+TEST(PDT_TEST, RANK) {
+    check_rank<true>(succinct::trie::LabelEncoding::RAW);
+    check_rank<false>(succinct::trie::LabelEncoding::RAW);
+    check_rank<false>(succinct::trie::LabelEncoding::TAIL_REPAIR);
+}
+
+// lower_bound(), select() and prefix_range() against the sorted keys
+template <bool Lexicographic>
+void check_ordered(succinct::trie::LabelEncoding encoding, bool navigation, bool encoded) {
+    std::mt19937_64 rng(29);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 2000; ++i) keys.push_back(random_key(rng, 8, "ab\x7f\x80\xff", 2, 2));
+    sort_unique(keys);
+    std::vector<std::string> sample(keys.begin(), keys.begin() + keys.size() / 2);
+    succinct::trie::KeyEncoder encoder(sample);
+    auto trie = build_trie<Lexicographic>(keys, encoding, encoded ? &encoder : nullptr);
+    auto& pdt = *trie;
+    if (navigation) pdt.build_navigation_index();
+    pdt.build_rank_index(3);
+    ASSERT_EQ(pdt.num_keys(), keys.size());
+
+    for (size_t r = 0; r < keys.size(); ++r) {
+        ASSERT_EQ(pdt.select(r), string_to_bytes(keys[r]));
+        ASSERT_EQ(pdt.rank_of_node(pdt.node_of_rank(r)), r);
+    }
+    std::vector<std::string> queries = key_queries(keys, 'a');
+    queries.insert(queries.end(), {"", "\xff\xff\xff\xff\xff\xff\xff\xff\xff", "c", "\x01"});
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const std::string& k = keys[i];
+        queries.push_back(k + "\x90");
+        std::string changed = k;
+        changed[i % k.size()] = "\x00\x7e\xfe"[i % 3];
+        queries.push_back(changed);
+    }
+    for (auto& q : queries) {
+        size_t expected = std::lower_bound(keys.begin(), keys.end(), q) - keys.begin();
+        ASSERT_EQ(pdt.lower_bound(q), expected) << q;
+    }
+    for (size_t i = 0; i < queries.size(); i += 7) {
+        const std::string& prefix = queries[i];
+        size_t expected = 0;
+        for (auto& k : keys) expected += k.compare(0, prefix.size(), prefix) == 0;
+        ASSERT_EQ(pdt.prefix_count(prefix), expected) << prefix;
+    }
+}
+
+TEST(PDT_TEST, ORDERED_OPERATIONS) {
+    for (bool navigation : {false, true}) {
+        check_ordered<true>(succinct::trie::LabelEncoding::RAW, navigation, false);
+        check_ordered<false>(succinct::trie::LabelEncoding::RAW, navigation, false);
+        check_ordered<false>(succinct::trie::LabelEncoding::TAIL, navigation, false);
+        check_ordered<false>(succinct::trie::LabelEncoding::TAIL_REPAIR, navigation, false);
+        check_ordered<true>(succinct::trie::LabelEncoding::RAW, navigation, true);
+        check_ordered<false>(succinct::trie::LabelEncoding::TAIL, navigation, true);
+    }
+}
+
+// light edges above `node`
+template <bool Lexicographic>
+size_t light_depth(const succinct::trie::DefaultPathDecomposedTrie<Lexicographic>& pdt, size_t node) {
+    size_t d = 0, branch_no;
+    uint16_t branch;
+    while (pdt.get_parent_node_branch_by_node_idx(node, node, branch, branch_no)) ++d;
+    return d;
+}
+
+// the heavy child by key weight: unit weights give the centroid trie, a
+// heavy key ends up on the root path
+TEST(PDT_TEST, WEIGHTED_DECOMPOSITION) {
+    std::mt19937_64 rng(31);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 3000; ++i) keys.push_back(random_key(rng, 10, "abcd"));
+    sort_unique(keys);
+    std::vector<uint64_t> weights(keys.size(), 0);
+    for (size_t i = 0; i < 64; ++i) ++weights[rng() % keys.size()];
+    size_t hottest = keys.size() / 3;
+    weights[hottest] = 1000;
+
+    std::vector<uint64_t> unit_weights(keys.size(), 1);
+    auto centroid_trie = build_trie<false>(keys);
+    auto unit_trie = build_trie<false>(keys, succinct::trie::LabelEncoding::RAW, nullptr, &unit_weights);
+    auto weighted_trie = build_trie<false>(keys, succinct::trie::LabelEncoding::RAW, nullptr, &weights);
+    auto& centroid = *centroid_trie;
+    auto& unit = *unit_trie;
+    auto& weighted = *weighted_trie;
+
+    EXPECT_EQ(get_label(unit.get_labels()), get_label(centroid.get_labels()));
+    EXPECT_EQ(get_bp_str(unit.get_bp()), get_bp_str(centroid.get_bp()));
+    EXPECT_EQ(get_branch_str(unit.get_branches()), get_branch_str(centroid.get_branches()));
+
+    uint64_t weighted_cost = 0, centroid_cost = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        int idx = weighted.index(keys[i]);
+        ASSERT_GE(idx, 0);
+        ASSERT_EQ(weighted[idx], string_to_bytes(keys[i]));
+        ASSERT_EQ(weighted.index(keys[i] + "e"), -1);
+        weighted_cost += weights[i] * light_depth(weighted, idx);
+        centroid_cost += weights[i] * light_depth(centroid, centroid.index(keys[i]));
+    }
+    EXPECT_EQ(weighted.index(keys[hottest]), 0);
+    EXPECT_LT(weighted_cost, centroid_cost);
+}
+
+// the BP with the darray select0
+TEST(PDT_TEST, INDEX_DARRAY_BP) {
+    check_wide_nodes<true, succinct::DarrayBpVector<>>();
+    check_wide_nodes<false, succinct::DarrayBpVector<>>();
+}
+
 inline std::string ubyes2str(std::vector<uint8_t> ubyte) {
     return std::string(ubyte.begin(), ubyte.end());
 }
@@ -379,6 +950,29 @@ TEST(PDT_TEST, OPERATOR_INDEX_2) {
     EXPECT_EQ(ubyes2str(pdt[6]), "peel");
 }
 
+TEST(PDT_TEST, SPACE_REPORT) {
+    succinct::DefaultTreeBuilder<true> pdt_builder;
+    succinct::trie::compacted_trie_builder
+            <succinct::DefaultTreeBuilder<true>>
+            trieBuilder(pdt_builder);
+    append_to_trie(trieBuilder, "three");
+    append_to_trie(trieBuilder, "trial");
+    append_to_trie(trieBuilder, "triangle");
+    append_to_trie(trieBuilder, "trie");
+    trieBuilder.finish();
+
+    succinct::trie::DefaultPathDecomposedTrie<true> pdt(trieBuilder);
+    succinct::SpaceReport report = pdt.space_report();
+    EXPECT_EQ(report.bytes("labels"), pdt.get_labels().size() * sizeof(uint16_t));
+    EXPECT_EQ(report.bytes("branches"), pdt.get_branches().size() * sizeof(uint16_t));
+    EXPECT_EQ(report.bytes("word_positions"), pdt.word_positions.size() * sizeof(uint64_t));
+    EXPECT_EQ(report.bytes("bp.bits"), pdt.get_bp().data().size() * sizeof(uint64_t));
+    EXPECT_GT(report.bytes("bp.block_rank_pairs"), 0);
+    EXPECT_EQ(report.total_bytes(), report.bytes("labels") + report.bytes("branches") +
+                                    report.bytes("word_positions") + pdt.get_bp().space_report().total_bytes());
+    EXPECT_EQ(report.mapped_bytes(), 0);
+}
+
 GTEST_API_ int main(int argc, char ** argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,95 @@
+//
+// Built with PDT_ENABLE_COUNTERS, see CMakeLists.txt.
+//
+#include <gtest/gtest.h>
+#include <thread>
+#include "path_decomposed_trie.h"
+#include "perf_counters.h"
+
+using succinct::counters::snapshot;
+using succinct::counters::reset;
+namespace counters = succinct::counters;
+
+static succinct::RsBitVector alternating_bits(size_t n) {
+    succinct::BitVectorBuilder builder;
+    for (size_t i = 0; i < n; ++i) {
+        builder.push_back(i % 2);
+    }
+    return succinct::RsBitVector(&builder);
+}
+
+TEST(PERF_COUNTERS_TEST, RANK_SELECT) {
+    succinct::RsBitVector bv = alternating_bits(10000);
+    reset();
+    for (size_t i = 0; i < 100; ++i) bv.rank(i * 10);
+    for (size_t i = 0; i < 50; ++i) bv.select(i * 10);
+    for (size_t i = 0; i < 20; ++i) bv.select0(i * 10);
+    auto s = snapshot();
+    EXPECT_EQ(s[counters::RANK], 100);
+    EXPECT_EQ(s[counters::SELECT], 50);
+    EXPECT_EQ(s[counters::SELECT0], 20);
+    // no select hints, every select is a binary search over the blocks
+    EXPECT_GT(s[counters::SELECT_STEPS], 0);
+    EXPECT_GT(s[counters::SELECT0_STEPS], 0);
+    EXPECT_EQ(s[counters::FIND_CLOSE], 0);
+
+    reset();
+    EXPECT_EQ(snapshot()[counters::RANK], 0);
+}
+
+TEST(PERF_COUNTERS_TEST, THREADS) {
+    succinct::RsBitVector bv = alternating_bits(1000);
+    reset();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&bv] {
+            for (size_t i = 0; i < 1000; ++i) bv.rank(i);
+        });
+    }
+    for (auto& t : threads) t.join();
+    bv.rank(1);
+    // the counters of the exited threads are kept
+    EXPECT_EQ(snapshot()[counters::RANK], 4001);
+}
+
+TEST(PERF_COUNTERS_TEST, TRIE) {
+    succinct::DefaultTreeBuilder<true> pdt_builder;
+    succinct::trie::compacted_trie_builder
+            <succinct::DefaultTreeBuilder<true>>
+            trieBuilder(pdt_builder);
+    std::vector<std::string> strs{"abcd", "abce", "abd", "b", "bcd", "bce"};
+    for (auto& s : strs) {
+        std::vector<uint8_t> bytes(s.begin(), s.end());
+        trieBuilder.append(bytes);
+    }
+    trieBuilder.finish();
+    succinct::trie::DefaultPathDecomposedTrie<true> pdt(trieBuilder);
+
+    reset();
+    for (auto& s : strs) {
+        EXPECT_NE(pdt.index(s), -1);
+    }
+    EXPECT_EQ(pdt.index("abcf"), -1);
+    auto s = snapshot();
+    EXPECT_EQ(s[counters::TRIE_INDEX], strs.size() + 1);
+    EXPECT_GE(s[counters::TRIE_INDEX_NODES], s[counters::TRIE_INDEX]);
+    EXPECT_GE(s[counters::TRIE_INDEX_LABELS], s[counters::TRIE_INDEX_NODES]);
+    EXPECT_GT(s[counters::TRIE_BRANCH_SCANS], 0);
+    EXPECT_GE(s[counters::TRIE_BRANCH_SCAN_STEPS], s[counters::TRIE_BRANCH_SCANS]);
+    EXPECT_GE(s[counters::SELECT0], s[counters::TRIE_INDEX_NODES]);
+    EXPECT_GT(s[counters::FIND_CLOSE], 0);
+
+    reset();
+    for (size_t i = 0; i < strs.size(); ++i) {
+        pdt[i];
+    }
+    s = snapshot();
+    EXPECT_EQ(s[counters::TRIE_ACCESS], strs.size());
+    EXPECT_GE(s[counters::TRIE_ACCESS_NODES], strs.size());
+    EXPECT_EQ(s[counters::TRIE_INDEX], 0);
+}
+
+GTEST_API_ int main(int argc, char ** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,76 @@
+//
+// QueryExecutor of query_executor.h
+//
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include "query_executor.h"
+#include "test_trie_util.h"
+
+typedef succinct::trie::DefaultPathDecomposedTrie<false> trie_t;
+
+TEST(QUERY_EXECUTOR_TEST, PARALLEL_FOR) {
+    for (size_t n_threads : {1, 2, 5}) {
+        succinct::trie::QueryExecutor executor(n_threads);
+        EXPECT_EQ(executor.num_threads(), n_threads);
+        for (size_t n : {0, 1, 7, 1000, 12345}) {
+            for (size_t chunk_size : {1, 3, 64, 100000}) {
+                std::vector<int> hits(n, 0);
+                std::atomic<size_t> calls{0};
+                executor.parallel_for(n, chunk_size, [&](size_t begin, size_t end) {
+                    ASSERT_LT(begin, end);
+                    ASSERT_LE(end - begin, chunk_size);
+                    for (size_t i = begin; i < end; ++i) ++hits[i];
+                    ++calls;
+                });
+                EXPECT_EQ(calls.load(), (n + chunk_size - 1) / chunk_size);
+                EXPECT_EQ(std::count(hits.begin(), hits.end(), 1), n);
+            }
+        }
+    }
+}
+
+// the first run of chunks is much slower, the other threads steal it
+TEST(QUERY_EXECUTOR_TEST, STEALING) {
+    succinct::trie::QueryExecutor executor(4);
+    std::vector<std::thread::id> owner(64);
+    executor.parallel_for(owner.size(), 1, [&](size_t begin, size_t) {
+        if (begin < 16) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        owner[begin] = std::this_thread::get_id();
+    });
+    std::set<std::thread::id> first_run_threads(owner.begin(), owner.begin() + 16);
+    EXPECT_GT(first_run_threads.size(), 1);
+}
+
+TEST(QUERY_EXECUTOR_TEST, INDEX_ACCESS_ALL) {
+    std::mt19937_64 rng(3);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 3000; ++i) keys.push_back(random_key(rng, 10, "abcdefgh"));
+    sort_unique(keys);
+    auto trie = build_trie<false>(keys);
+    const trie_t& pdt = *trie;
+
+    std::vector<std::string> queries;
+    for (size_t i = 0; i < 20000; ++i) {
+        queries.push_back(keys[rng() % keys.size()] + (i % 3 ? "" : "x"));
+    }
+    succinct::trie::QueryExecutor executor(3);
+    std::vector<int> ids(queries.size());
+    succinct::trie::index_all(executor, pdt, queries.data(), queries.size(), ids.data(), 100);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        ASSERT_EQ(ids[i], pdt.index(queries[i]));
+    }
+
+    std::vector<size_t> nodes;
+    for (int id : ids) if (id >= 0) nodes.push_back(size_t(id));
+    std::vector<std::vector<uint8_t>> values(nodes.size());
+    succinct::trie::access_all(executor, pdt, nodes.data(), nodes.size(), values.data(), 50);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        ASSERT_EQ(values[i], pdt[nodes[i]]);
+    }
+}
+
+GTEST_API_ int main(int argc, char ** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,76 @@
+//
+// TrieStats of trie_stats.h
+//
+#include <gtest/gtest.h>
+#include "test_trie_util.h"
+
+template <bool Lexicographic>
+void check_stats(const std::vector<std::string>& keys) {
+    succinct::trie::TrieStats build_stats;
+    succinct::DefaultTreeBuilder<Lexicographic> pdt_builder;
+    pdt_builder.set_stats(&build_stats);
+    succinct::trie::compacted_trie_builder
+            <succinct::DefaultTreeBuilder<Lexicographic>>
+            trieBuilder(pdt_builder);
+    for (auto& s : keys) {
+        std::vector<uint8_t> bytes(s.begin(), s.end());
+        trieBuilder.append(bytes);
+    }
+    trieBuilder.finish();
+    succinct::trie::DefaultPathDecomposedTrie<Lexicographic> pdt(trieBuilder);
+
+    auto stats = succinct::trie::TrieStats::collect(pdt);
+    EXPECT_EQ(stats.n_nodes, keys.size());
+
+    // the builder sees the same branching points and label runs
+    EXPECT_EQ(build_stats.n_nodes, stats.n_nodes);
+    EXPECT_EQ(build_stats.n_labels, stats.n_labels);
+    EXPECT_EQ(build_stats.n_branching_points, stats.n_branching_points);
+    EXPECT_EQ(build_stats.branching_fanout, stats.branching_fanout);
+    EXPECT_EQ(build_stats.label_runs, stats.label_runs);
+
+    // depth and fan-out against the navigation of the trie
+    succinct::trie::TrieStats::histogram depth, fanout;
+    uint64_t light_children = 0;
+    for (size_t node = 0; node < keys.size(); ++node) {
+        size_t d = 0, idx = node, branch_no;
+        uint16_t branch;
+        while (pdt.get_parent_node_branch_by_node_idx(idx, idx, branch, branch_no)) ++d;
+        succinct::trie::TrieStats::inc(depth, d);
+        size_t end, num;
+        pdt.get_branch_idx_by_node_idx(node, end, num);
+        succinct::trie::TrieStats::inc(fanout, num);
+        light_children += num;
+    }
+    EXPECT_EQ(stats.light_depth, depth);
+    EXPECT_EQ(stats.fanout, fanout);
+    EXPECT_EQ(light_children, keys.size() - 1);
+
+    uint64_t path_bytes = 0;
+    for (size_t v = 0; v < stats.path_length.size(); ++v) path_bytes += v * stats.path_length[v];
+    EXPECT_EQ(path_bytes, stats.n_labels + stats.n_branching_points);
+}
+
+TEST(TRIE_STATS_TEST, LEX) {
+    check_stats<true>(random_keys(2000, 1));
+    check_stats<true>({"three", "trial", "triangle", "triangular", "trie", "triple", "triply"});
+}
+
+TEST(TRIE_STATS_TEST, CENTROID) {
+    check_stats<false>(random_keys(2000, 2));
+    check_stats<false>({"a", "b", "c"});
+}
+
+TEST(TRIE_STATS_TEST, SCANS) {
+    succinct::trie::TrieStats stats;
+    // a branching point with 4 light branches: scans of 1, 2, 3 and 4 branches
+    stats.add_compacted_node(5, 0);
+    EXPECT_DOUBLE_EQ(stats.fraction_scans_longer_than(0), 1.0);
+    EXPECT_DOUBLE_EQ(stats.fraction_scans_longer_than(2), 0.5);
+    EXPECT_DOUBLE_EQ(stats.fraction_scans_longer_than(4), 0.0);
+}
+
+GTEST_API_ int main(int argc, char ** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
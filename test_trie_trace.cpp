@@ -0,0 +1,76 @@
+//
+// index_traced / Trace of path_decomposed_trie.h
+//
+#include <gtest/gtest.h>
+#include "test_trie_util.h"
+
+TEST(TRIE_TRACE_TEST, SAME_RESULT_AS_INDEX) {
+    std::vector<std::string> strs{"abcd", "abce", "abd", "b", "bcd", "bce"};
+    auto pdt = build_trie<true>(strs);
+
+    succinct::trie::Trace trace;
+    for (auto& s : strs) {
+        int idx = pdt->index(s);
+        EXPECT_EQ(pdt->index_traced(s, trace), idx);
+        EXPECT_EQ(trace.result, idx);
+        ASSERT_FALSE(trace.nodes.empty());
+        EXPECT_EQ(trace.nodes[0].node_idx, 0);
+        EXPECT_EQ(trace.nodes.back().node_idx, size_t(idx));
+        // the key and its WORD_EOF are matched
+        EXPECT_GE(trace.labels_compared(), s.size() + 1 - (trace.nodes.size() - 1));
+        EXPECT_GE(trace.bp_positions.size(), trace.nodes.size());
+        EXPECT_TRUE(trace.cache_lines.empty());
+    }
+
+    EXPECT_EQ(pdt->index_traced("abcf", trace), -1);
+    EXPECT_EQ(trace.result, -1);
+    EXPECT_FALSE(trace.nodes.empty());
+    EXPECT_NE(trace.explain().find("result -1"), std::string::npos);
+}
+
+TEST(TRIE_TRACE_TEST, WIDE_NODE) {
+    // a node with 200 children under "k"
+    std::vector<std::string> strs;
+    for (int i = 0; i < 200; ++i) {
+        std::string s("k");
+        s += char(i + 32);
+        s += "tail";
+        strs.push_back(s);
+    }
+    std::sort(strs.begin(), strs.end());
+    auto pdt = build_trie<false>(strs);
+
+    succinct::trie::Trace trace;
+    size_t longest = 0;
+    for (auto& s : strs) {
+        ASSERT_NE(pdt->index_traced(s, trace), -1);
+        longest = std::max(longest, trace.longest_branch_scan());
+        EXPECT_LE(trace.nodes.size(), 2);
+    }
+    // one of the light children is found after scanning all the others
+    EXPECT_EQ(longest, 199);
+}
+
+TEST(TRIE_TRACE_TEST, CACHE_LINES) {
+    std::vector<std::string> strs;
+    for (int i = 0; i < 1000; ++i) {
+        strs.push_back("key" + std::to_string(i) + "$");
+    }
+    std::sort(strs.begin(), strs.end());
+    auto pdt = build_trie<true>(strs);
+
+    succinct::trie::Trace trace;
+    trace.record_cache_lines = true;
+    for (auto& s : strs) {
+        ASSERT_NE(pdt->index_traced(s, trace), -1);
+        EXPECT_FALSE(trace.cache_lines.empty());
+        std::vector<uintptr_t> lines(trace.cache_lines);
+        std::sort(lines.begin(), lines.end());
+        EXPECT_EQ(std::unique(lines.begin(), lines.end()), lines.end());
+    }
+}
+
+GTEST_API_ int main(int argc, char ** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,61 @@
+//
+// Random keys and trie construction shared by the trie tests.
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_TEST_TRIE_UTIL_H
+#define PATH_DECOMPOSITION_TRIE_TEST_TRIE_UTIL_H
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "path_decomposed_trie.h"
+
+// a key of 1 to `max_len` bytes of `alphabet`, the first `head` of them from
+// its first `head_size` bytes only (so that the keys share prefixes)
+inline std::string random_key(std::mt19937_64& rng, size_t max_len, const std::string& alphabet,
+                              size_t head = 0, size_t head_size = 0) {
+    std::string s;
+    size_t len = 1 + rng() % max_len;
+    for (size_t j = 0; j < len; ++j) s += alphabet[rng() % (j < head ? head_size : alphabet.size())];
+    return s;
+}
+
+inline void sort_unique(std::vector<std::string>& keys) {
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+// up to `n` sorted distinct keys of 1 to 12 lowercase letters
+inline std::vector<std::string> random_keys(size_t n, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < n; ++i) keys.push_back(random_key(rng, 12, "abcdefghijklmnopqrst", 2, 3));
+    sort_unique(keys);
+    return keys;
+}
+
+// the trie of the sorted `keys`, through `encoder` and weighted by `weights`
+// if not null
+template <bool Lexicographic>
+std::unique_ptr<succinct::trie::DefaultPathDecomposedTrie<Lexicographic>> build_trie(
+        const std::vector<std::string>& keys,
+        succinct::trie::LabelEncoding encoding = succinct::trie::LabelEncoding::RAW,
+        const succinct::trie::KeyEncoder* encoder = nullptr,
+        const std::vector<uint64_t>* weights = nullptr) {
+    succinct::DefaultTreeBuilder<Lexicographic> pdt_builder;
+    if (weights) pdt_builder.set_weighted(true);
+    succinct::trie::compacted_trie_builder
+            <succinct::DefaultTreeBuilder<Lexicographic>>
+            trieBuilder(pdt_builder, encoder);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        std::vector<uint8_t> bytes(keys[i].begin(), keys[i].end());
+        trieBuilder.append(bytes, weights ? (*weights)[i] : 1);
+    }
+    trieBuilder.finish();
+    return std::unique_ptr<succinct::trie::DefaultPathDecomposedTrie<Lexicographic>>(
+            new succinct::trie::DefaultPathDecomposedTrie<Lexicographic>(trieBuilder, encoding));
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_TEST_TRIE_UTIL_H
@@ -0,0 +1,110 @@
+//
+// Dense table of the lookup states after the first bytes of a key, in front
+// of DefaultPathDecomposedTrie::index(), see `build_top_level_table()`.
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_TOP_LEVEL_TABLE_H
+#define PATH_DECOMPOSITION_TRIE_TOP_LEVEL_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mappable_vector.h"
+#include "space_report.h"
+
+namespace succinct {
+    namespace trie {
+        // Where `index()` is between two labels: about to compare the label
+        // `label_idx` of the node `node_idx` with the symbol `matching_idx` of
+        // the key, the next run of light branches of the node starting at
+        // `branch_idx`. -1 are the first label and branch of the node.
+        struct IndexState {
+            size_t node_idx = 0;
+            size_t label_idx = size_t(-1);
+            size_t branch_idx = size_t(-1);
+            size_t matching_idx = 0;
+        };
+
+        //
+        // For each of the 256^`prefix_len` byte strings, the IndexState after
+        // matching it from the root, MISS if no key starts with it, or
+        // FROM_ROOT if it ends in a node tail (see `separate_tails()`). A key of
+        // at least `prefix_len` bytes starts there: the root region hops, the
+        // same for every lookup but dependent misses in a large trie, become
+        // one read of the table.
+        //
+        // 12 bytes per entry: 3KB for 1 byte, 768KB for 2 bytes, 192MB for 3.
+        //
+        struct TopLevelTable {
+            static const uint32_t MISS = uint32_t(-1);
+            static const uint32_t FROM_ROOT = uint32_t(-2);
+            static const size_t MAX_PREFIX_LEN = 3;
+
+            size_t prefix_len = 0;                  // 0: no table
+            mappable_vector<uint32_t> nodes;
+            mappable_vector<uint32_t> labels;
+            mappable_vector<uint32_t> branches;
+
+            static size_t entry_bytes() {
+                return 3 * sizeof(uint32_t);
+            }
+
+            // the longest prefix whose table fits in `budget_bytes`, 0 if none
+            static size_t prefix_len_for(size_t budget_bytes) {
+                size_t len = 0;
+                while (len < MAX_PREFIX_LEN && (entry_bytes() << (8 * (len + 1))) <= budget_bytes) {
+                    ++len;
+                }
+                return len;
+            }
+
+            bool empty() const {
+                return !prefix_len;
+            }
+
+            // the table applies to keys of `key_len` bytes
+            inline bool covers(size_t key_len) const {
+                return prefix_len && key_len >= prefix_len;
+            }
+
+            // the first `prefix_len` symbols of `key`, big endian
+            inline size_t slot(const uint16_t* key) const {
+                size_t s = 0;
+                for (size_t i = 0; i < prefix_len; ++i) {
+                    s = s << 8 | key[i];
+                }
+                return s;
+            }
+
+            // false if no key starts with the prefix of `key`, `state` is
+            // left at the root for FROM_ROOT
+            inline bool lookup(const uint16_t* key, IndexState& state) const {
+                size_t s = slot(key);
+                if (nodes[s] == MISS) return false;
+                if (nodes[s] == FROM_ROOT) return true;
+                state.node_idx = nodes[s];
+                state.label_idx = labels[s];
+                state.branch_idx = branches[s];
+                state.matching_idx = prefix_len;
+                return true;
+            }
+
+            void swap(TopLevelTable& other) {
+                std::swap(prefix_len, other.prefix_len);
+                nodes.swap(other.nodes);
+                labels.swap(other.labels);
+                branches.swap(other.branches);
+            }
+
+            SpaceReport space_report() const {
+                SpaceReport report;
+                report.add("nodes", nodes);
+                report.add("labels", labels);
+                report.add("branches", branches);
+                return report;
+            }
+        };
+    }
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_TOP_LEVEL_TABLE_H
@@ -0,0 +1,166 @@
+//
+// Shape statistics of a path decomposed trie.
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_TRIE_STATS_H
+#define PATH_DECOMPOSITION_TRIE_TRIE_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace succinct {
+    namespace trie {
+        // `collect(trie)` computes everything in one pass over the labels and
+        // one over the BP bits. A TrieStats given to DefaultTreeBuilder::set_stats
+        // is filled while building, with only what the builder sees: `n_nodes`,
+        // `n_labels`, `branching_fanout` and `label_runs`.
+        struct TrieStats {
+            typedef std::vector<uint64_t> histogram;     // value -> count
+
+            uint64_t n_nodes = 0;               // = number of keys, one node per heavy path
+            uint64_t n_labels = 0;              // bytes of the label runs (WORD_EOF included)
+            uint64_t n_branching_points = 0;
+
+            histogram light_depth;              // nodes per depth in the decomposed tree (root = 0)
+            histogram path_length;              // nodes per heavy path length (bytes)
+            histogram fanout;                   // nodes per number of light children
+            histogram branching_fanout;         // branching points per number of light branches
+            histogram label_runs;               // runs of bytes between two branching points
+
+            static void inc(histogram& h, size_t v, uint64_t n = 1) {
+                if (h.size() <= v) h.resize(v + 1, 0);
+                h[v] += n;
+            }
+
+            static double mean(const histogram& h) {
+                uint64_t n = 0, sum = 0;
+                for (size_t v = 0; v < h.size(); ++v) {
+                    n += h[v];
+                    sum += v * h[v];
+                }
+                return n ? double(sum) / n : 0;
+            }
+
+            double avg_light_depth() const { return mean(light_depth); }
+
+            double avg_path_length() const { return mean(path_length); }
+
+            double avg_label_run() const { return mean(label_runs); }
+
+            // Fraction of the light-branch scans of `index()` that compare more
+            // than `n` branches, each light child being reached once: a branching
+            // point with k light branches gives scans of length 1, 2, ..., k.
+            double fraction_scans_longer_than(size_t n) const {
+                uint64_t total = 0, longer = 0;
+                for (size_t k = 1; k < branching_fanout.size(); ++k) {
+                    total += k * branching_fanout[k];
+                    if (k > n) longer += (k - n) * branching_fanout[k];
+                }
+                return total ? double(longer) / total : 0;
+            }
+
+            // builder hooks, see DefaultTreeBuilder::node
+            void add_compacted_node(size_t n_children, size_t skip) {
+                inc(label_runs, skip);
+                n_labels += skip;
+                if (n_children) {
+                    ++n_branching_points;
+                    inc(branching_fanout, n_children - 1);
+                } else {
+                    ++n_nodes;
+                }
+            }
+
+            template <typename Trie>
+            static TrieStats collect(const Trie& trie) {
+                TrieStats stats;
+                const auto& labels = trie.get_labels();
+                const auto& bp = trie.get_bp();
+                stats.n_nodes = trie.word_positions.size() - 1;
+
+                // labels: run [special heavy-char run]... DELIMITER per node
+                size_t run = 0, path = 0;
+                for (size_t i = 0; i < labels.size(); ++i) {
+                    uint16_t l = labels[i];
+                    if (l >> 8 == 1) {
+                        inc(stats.label_runs, run);
+                        inc(stats.branching_fanout, (l & 0xFF) + 1);
+                        ++stats.n_branching_points;
+                        path += run + 1;
+                        run = 0;
+                        ++i;    // the heavy child's char
+                    } else if (l >> 8 == 2) {
+                        inc(stats.label_runs, run);
+                        inc(stats.path_length, path + run);
+                        path = run = 0;
+                    } else {
+                        ++run;
+                    }
+                }
+                stats.n_labels = 0;
+                for (size_t v = 0; v < stats.label_runs.size(); ++v) {
+                    stats.n_labels += v * stats.label_runs[v];
+                }
+
+                // BP (DFUDS): node i is its light children "(" followed by ")",
+                // after a fake root "(". Nodes are in preorder, so the depth of
+                // a node is the number of ancestors with children left to visit.
+                std::vector<uint64_t> children_left;
+                size_t ones = 0, node = 0;
+                for (size_t pos = 0; pos < bp.size(); ++pos) {
+                    if (bp[pos]) {
+                        ++ones;
+                        continue;
+                    }
+                    size_t n_children = node ? ones : ones - 1;
+                    while (!children_left.empty() && !children_left.back()) children_left.pop_back();
+                    if (!children_left.empty()) --children_left.back();
+                    inc(stats.light_depth, children_left.size());
+                    inc(stats.fanout, n_children);
+                    children_left.push_back(n_children);
+                    ones = 0;
+                    ++node;
+                }
+                return stats;
+            }
+
+            std::string to_json() const {
+                std::ostringstream out;
+                out << "{\"nodes\": " << n_nodes
+                    << ", \"labels\": " << n_labels
+                    << ", \"branching_points\": " << n_branching_points
+                    << ", \"avg_light_depth\": " << avg_light_depth()
+                    << ", \"avg_path_length\": " << avg_path_length()
+                    << ", \"avg_label_run\": " << avg_label_run()
+                    << ", \"scans_longer_than\": {";
+                const size_t thresholds[] = {1, 4, 16, 64};
+                for (size_t i = 0; i < 4; ++i) {
+                    out << (i ? ", " : "") << "\"" << thresholds[i] << "\": "
+                        << fraction_scans_longer_than(thresholds[i]);
+                }
+                out << "}";
+                write_histogram(out, "light_depth", light_depth);
+                write_histogram(out, "path_length", path_length);
+                write_histogram(out, "fanout", fanout);
+                write_histogram(out, "branching_fanout", branching_fanout);
+                write_histogram(out, "label_runs", label_runs);
+                out << "}";
+                return out.str();
+            }
+
+        private:
+            static void write_histogram(std::ostringstream& out, const char* name, const histogram& h) {
+                out << ", \"" << name << "\": [";
+                for (size_t v = 0; v < h.size(); ++v) {
+                    out << (v ? ", " : "") << h[v];
+                }
+                out << "]";
+            }
+        };
+    }
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_TRIE_STATS_H
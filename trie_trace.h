@@ -0,0 +1,152 @@
+//
+// Per-query trace of DefaultPathDecomposedTrie::index_traced.
+//
+
+#ifndef PATH_DECOMPOSITION_TRIE_TRIE_TRACE_H
+#define PATH_DECOMPOSITION_TRIE_TRIE_TRACE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace succinct {
+    namespace trie {
+        // The tracer of `index()`, every hook is empty and compiled away.
+        struct NullTracer {
+            inline void node(size_t, size_t, size_t, size_t) {}
+            inline void label(size_t, const uint16_t*) {}
+            inline void branch(const uint16_t*) {}
+            inline void branch_scan(size_t, bool) {}
+            inline void bp(uint64_t, const uint64_t*) {}
+            inline void touch(const void*) {}
+        };
+
+        // Records the nodes entered by a lookup with the bytes of the key
+        // matched before each, see `index_sorted_batch()`.
+        struct NodePathTracer : NullTracer {
+            std::vector<std::pair<size_t, size_t>> nodes;     // (node_idx, key_offset)
+
+            inline void node(size_t node_idx, size_t, size_t, size_t key_offset) {
+                nodes.emplace_back(node_idx, key_offset);
+            }
+        };
+
+        // One node of the path followed by the lookup.
+        struct TraceNode {
+            size_t node_idx;
+            size_t bp_idx;              // position of the node's ")" in BP, -1 with the navigation index
+            size_t label_begin;         // index of the node's first label in `m_labels`
+            size_t key_offset;          // bytes of the key matched before the node
+            std::vector<uint16_t> labels;               // labels compared, in order
+            std::vector<size_t> branch_scans;           // branches compared by each light-branch scan
+        };
+
+        // What `index_traced` did for one key: nodes, labels, branch scans,
+        // BP positions and (if `record_cache_lines`) the distinct 64-byte
+        // lines of the labels, branches, word_positions, navigation arrays and BP
+        // words touched.
+        // The lines of the rank/select and min-excess directories are not included.
+        struct Trace {
+            bool record_cache_lines = false;
+
+            std::vector<TraceNode> nodes;
+            std::vector<uint64_t> bp_positions;
+            std::vector<uintptr_t> cache_lines;     // in first-touch order
+            int result = -1;
+
+            void clear() {
+                nodes.clear();
+                bp_positions.clear();
+                cache_lines.clear();
+                m_seen_lines.clear();
+                result = -1;
+            }
+
+            size_t labels_compared() const {
+                size_t n = 0;
+                for (auto& node : nodes) n += node.labels.size();
+                return n;
+            }
+
+            size_t branches_compared() const {
+                size_t n = 0;
+                for (auto& node : nodes) {
+                    for (auto len : node.branch_scans) n += len;
+                }
+                return n;
+            }
+
+            size_t longest_branch_scan() const {
+                size_t n = 0;
+                for (auto& node : nodes) {
+                    for (auto len : node.branch_scans) n = std::max(n, len);
+                }
+                return n;
+            }
+
+            // human readable dump, one line per node
+            std::string explain() const {
+                std::ostringstream out;
+                out << "result " << result << ": " << nodes.size() << " nodes, "
+                    << labels_compared() << " labels, " << branches_compared() << " branches compared, "
+                    << bp_positions.size() << " BP positions";
+                if (record_cache_lines) out << ", " << cache_lines.size() << " cache lines";
+                out << "\n";
+                for (auto& node : nodes) {
+                    out << "  node " << node.node_idx << " (bp " << node.bp_idx
+                        << ", labels from " << node.label_begin << ", key offset " << node.key_offset << "):";
+                    for (auto l : node.labels) {
+                        if (l >> 8) out << " <" << l << ">";
+                        else out << " " << (l >= 0x20 && l < 0x7F ? std::string(1, char(l)) : std::to_string(l));
+                    }
+                    if (!node.branch_scans.empty()) {
+                        out << " | branch scans:";
+                        for (auto len : node.branch_scans) out << " " << len;
+                    }
+                    out << "\n";
+                }
+                return out.str();
+            }
+
+            // tracer hooks, called by DefaultPathDecomposedTrie::index_impl
+
+            inline void node(size_t node_idx, size_t bp_idx, size_t label_begin, size_t key_offset) {
+                nodes.push_back(TraceNode{node_idx, bp_idx, label_begin, key_offset, {}, {}});
+            }
+
+            inline void label(size_t, const uint16_t* p) {
+                nodes.back().labels.push_back(*p);
+                touch(p);
+            }
+
+            inline void branch(const uint16_t* p) {
+                touch(p);
+            }
+
+            inline void branch_scan(size_t len, bool) {
+                nodes.back().branch_scans.push_back(len);
+            }
+
+            inline void bp(uint64_t pos, const uint64_t* word) {
+                bp_positions.push_back(pos);
+                touch(word);
+            }
+
+            inline void touch(const void* p) {
+                if (!record_cache_lines) return;
+                uintptr_t line = reinterpret_cast<uintptr_t>(p) / 64;
+                if (m_seen_lines.insert(line).second) cache_lines.push_back(line);
+            }
+
+        private:
+            std::unordered_set<uintptr_t> m_seen_lines;
+        };
+    }
+}
+
+#endif //PATH_DECOMPOSITION_TRIE_TRIE_TRACE_H